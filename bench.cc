@@ -0,0 +1,300 @@
+/*
+ * Benchmark mode: ./a.out bench [options]
+ *
+ *   --seed N                   seed of the generated grammars (default 1)
+ *   --non-terminals N          base parameters of the generated grammars,
+ *   --terminals N              see GrammarGenParams
+ *   --alternatives N
+ *   --rhs-length N
+ *   --epsilon-density F
+ *   --left-recursion-depth N
+ *   --shared-prefix-depth N
+ *   --sweep NAME=V1,V2,...     vary one parameter over the given values,
+ *                              may be repeated (default: a sweep of every
+ *                              parameter)
+ *   --repeat N                 runs per grammar, the fastest is reported
+ *   --tasks DIGITS             tasks to time (default 12345)
+ *   --format csv|json          csv (default) or one JSON object per line
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "grammargen.h"
+#include "lexer.h"
+#include "project2.h"
+
+using namespace std;
+
+struct BenchSweep
+{
+    string name;
+    vector<double> values;
+};
+
+enum BenchPhase { LEX = 0, READ_GRAMMAR, FETCH_TYPES, TASK1, TASK2, TASK3, TASK4, TASK5, PHASE_COUNT };
+
+static const char *phase_names[PHASE_COUNT] = {
+    "lex", "readGrammar", "fetchTypes", "task1", "task2", "task3", "task4", "task5"};
+
+class NullBuffer : public streambuf
+// Swallows task output so that only the analysis is timed
+{
+  protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+static bool setParam(GrammarGenParams &params, const string &name, double value)
+{
+    if (name == "non-terminals")
+        params.non_terminals = (int)value;
+    else if (name == "terminals")
+        params.terminals = (int)value;
+    else if (name == "alternatives")
+        params.alternatives = (int)value;
+    else if (name == "rhs-length")
+        params.rhs_length = (int)value;
+    else if (name == "epsilon-density")
+        params.epsilon_density = value;
+    else if (name == "left-recursion-depth")
+        params.left_recursion_depth = (int)value;
+    else if (name == "shared-prefix-depth")
+        params.shared_prefix_depth = (int)value;
+    else
+        return false;
+    return true;
+}
+
+static bool parseSweep(const string &spec, BenchSweep &sweep)
+{
+    size_t eq = spec.find('=');
+    if (eq == string::npos)
+        return false;
+    sweep.name = spec.substr(0, eq);
+    stringstream values(spec.substr(eq + 1));
+    string value;
+    while (getline(values, value, ','))
+        sweep.values.push_back(atof(value.c_str()));
+    return !sweep.values.empty();
+}
+
+static vector<BenchSweep> defaultSweeps()
+{
+    return {
+        {"non-terminals", {25, 50, 100, 200, 400}},
+        {"terminals", {5, 20, 80, 320}},
+        {"alternatives", {2, 4, 8, 16}},
+        {"rhs-length", {2, 4, 8, 16, 32}},
+        {"epsilon-density", {0, 0.1, 0.2, 0.4}},
+        {"left-recursion-depth", {0, 1, 2, 4}},
+        {"shared-prefix-depth", {0, 1, 2, 4}},
+    };
+}
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void runTask(int task, const CharacterType &c, const vector<Rule> &rules, ostream &out)
+{
+    switch (task)
+    {
+    case 1:
+        Task1(rules, out);
+        break;
+    case 2:
+        Task2(c, rules, out);
+        break;
+    case 3:
+        Task3(c, rules, out);
+        break;
+    case 4:
+        Task4(c, rules, out);
+        break;
+    case 5:
+        Task5(c, rules, out);
+        break;
+    }
+}
+
+static void benchGrammar(const GrammarGenParams &params, int repeat, const string &tasks, vector<double> &best, size_t &input_bytes, size_t &rule_count)
+// Fastest time of each phase over "repeat" runs, -1 for phases not run
+{
+    string grammar = generateGrammar(params);
+    input_bytes = grammar.size();
+    best.assign(PHASE_COUNT, -1);
+
+    NullBuffer null_buffer;
+    ostream null_out(&null_buffer);
+    for (int run = 0; run < repeat; run++)
+    {
+        double times[PHASE_COUNT];
+        for (int p = 0; p < PHASE_COUNT; p++)
+            times[p] = -1;
+
+        istringstream input(grammar);
+        auto start = chrono::steady_clock::now();
+        LexicalAnalyzer lexer(input);
+        times[LEX] = secondsSince(start);
+
+        vector<Rule> rules;
+        start = chrono::steady_clock::now();
+        readGrammar(lexer, rules);
+        times[READ_GRAMMAR] = secondsSince(start);
+        rule_count = rules.size();
+
+        start = chrono::steady_clock::now();
+        CharacterType c = fetchTypes(rules);
+        times[FETCH_TYPES] = secondsSince(start);
+
+        for (char t : tasks)
+        {
+            int task = t - '0';
+            if (task < 1 || task > 5)
+                continue;
+            start = chrono::steady_clock::now();
+            runTask(task, c, rules, null_out);
+            times[TASK1 + task - 1] = secondsSince(start);
+        }
+
+        for (int p = 0; p < PHASE_COUNT; p++)
+        {
+            if (times[p] >= 0 && (best[p] < 0 || times[p] < best[p]))
+                best[p] = times[p];
+        }
+    }
+}
+
+static void printHeader(const string &format)
+{
+    if (format != "csv")
+        return;
+    cout << "sweep,value,seed,non_terminals,terminals,alternatives,rhs_length,"
+         << "epsilon_density,left_recursion_depth,shared_prefix_depth,input_bytes,rules";
+    for (int p = 0; p < PHASE_COUNT; p++)
+        cout << "," << phase_names[p];
+    cout << "\n";
+}
+
+static void printResult(const string &format, const BenchSweep &sweep, double value, const GrammarGenParams &params, size_t input_bytes, size_t rule_count, const vector<double> &best)
+{
+    char number[64];
+    if (format == "csv")
+    {
+        cout << sweep.name << "," << value << "," << params.seed << ","
+             << params.non_terminals << "," << params.terminals << ","
+             << params.alternatives << "," << params.rhs_length << ","
+             << params.epsilon_density << "," << params.left_recursion_depth << ","
+             << params.shared_prefix_depth << "," << input_bytes << "," << rule_count;
+        for (int p = 0; p < PHASE_COUNT; p++)
+        {
+            cout << ",";
+            if (best[p] >= 0)
+            {
+                snprintf(number, sizeof(number), "%.9f", best[p]);
+                cout << number;
+            }
+        }
+        cout << "\n";
+        return;
+    }
+
+    cout << "{\"sweep\": \"" << sweep.name << "\", \"value\": " << value
+         << ", \"seed\": " << params.seed
+         << ", \"non_terminals\": " << params.non_terminals
+         << ", \"terminals\": " << params.terminals
+         << ", \"alternatives\": " << params.alternatives
+         << ", \"rhs_length\": " << params.rhs_length
+         << ", \"epsilon_density\": " << params.epsilon_density
+         << ", \"left_recursion_depth\": " << params.left_recursion_depth
+         << ", \"shared_prefix_depth\": " << params.shared_prefix_depth
+         << ", \"input_bytes\": " << input_bytes
+         << ", \"rules\": " << rule_count
+         << ", \"seconds\": {";
+    bool first = true;
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        if (best[p] < 0)
+            continue;
+        snprintf(number, sizeof(number), "%.9f", best[p]);
+        cout << (first ? "" : ", ") << "\"" << phase_names[p] << "\": " << number;
+        first = false;
+    }
+    cout << "}}\n";
+}
+
+static void benchUsage()
+{
+    cerr << "Usage: a.out bench [--seed N] [--non-terminals N] [--terminals N] [--alternatives N]\n"
+         << "                   [--rhs-length N] [--epsilon-density F] [--left-recursion-depth N]\n"
+         << "                   [--shared-prefix-depth N] [--sweep NAME=V1,V2,...] [--repeat N]\n"
+         << "                   [--tasks DIGITS] [--format csv|json]\n";
+}
+
+int runBenchmark(int argc, char *argv[])
+{
+    GrammarGenParams base;
+    vector<BenchSweep> sweeps;
+    int repeat = 3;
+    string tasks = "12345";
+    string format = "csv";
+
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        if (i + 1 >= argc || option.compare(0, 2, "--") != 0)
+        {
+            benchUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        BenchSweep sweep;
+        if (option == "--seed")
+            base.seed = strtoull(value.c_str(), NULL, 10);
+        else if (option == "--sweep" && parseSweep(value, sweep))
+            sweeps.push_back(sweep);
+        else if (option == "--repeat")
+            repeat = max(1, atoi(value.c_str()));
+        else if (option == "--tasks")
+            tasks = value;
+        else if (option == "--format" && (value == "csv" || value == "json"))
+            format = value;
+        else if (!setParam(base, option.substr(2), atof(value.c_str())))
+        {
+            benchUsage();
+            return 1;
+        }
+    }
+    if (sweeps.empty())
+        sweeps = defaultSweeps();
+
+    printHeader(format);
+    for (const BenchSweep &sweep : sweeps)
+    {
+        for (double value : sweep.values)
+        {
+            GrammarGenParams params = base;
+            if (!setParam(params, sweep.name, value))
+            {
+                cerr << "Error: unknown sweep parameter " << sweep.name << "\n";
+                return 1;
+            }
+            vector<double> best;
+            size_t input_bytes = 0, rule_count = 0;
+            benchGrammar(params, repeat, tasks, best, input_bytes, rule_count);
+            printResult(format, sweep, value, params, input_bytes, rule_count, best);
+            cout.flush();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,13 @@
+/*
+ * Benchmark mode: ./a.out bench [options]
+ *
+ * Generates grammars with generateGrammar, times lexing, readGrammar,
+ * fetchTypes and Task1-Task5 separately over parameter sweeps and writes
+ * one CSV line (or JSON object) per grammar to standard output.
+ */
+#ifndef __BENCH__H__
+#define __BENCH__H__
+
+int runBenchmark(int argc, char *argv[]);
+
+#endif //__BENCH__H__
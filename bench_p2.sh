@@ -0,0 +1,36 @@
+#!/bin/bash
+
+if [ ! -e "./a.out" ]; then
+    echo "Error: a.out not found!"
+    exit 1
+fi
+
+if [ ! -x "./a.out" ]; then
+    echo "Error: a.out not executable!"
+    exit 1
+fi
+
+usage()
+{
+    echo
+    echo "Usage: $0 [output_file] [bench options]"
+    echo
+    echo "Runs ./a.out bench and writes the results to output_file"
+    echo "(default bench_output.txt). Run ./a.out bench --help for the options."
+    echo
+    exit 1
+}
+
+output_file=./bench_output.txt
+if [ "$#" -ge "1" ] && [[ ! "$1" =~ ^-- ]]; then
+    output_file=$1
+    shift
+fi
+
+if ! ./a.out bench "$@" > ${output_file}; then
+    usage
+fi
+
+echo
+echo "Benchmark results written to ${output_file}"
+echo
@@ -0,0 +1,47 @@
+/*
+ * A table of equally sized bitsets, stored in one array of 64 bit words.
+ */
+#ifndef __BITSETS__H__
+#define __BITSETS__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Bitsets
+{
+  public:
+    Bitsets(std::size_t rows = 0, std::size_t bits = 0)
+        : rows(rows), words((bits + 63) / 64), data(rows * words, 0)
+    {
+    }
+
+    std::size_t Rows() const { return rows; }
+    std::size_t Words() const { return words; }
+    uint64_t *Row(std::size_t row) { return data.data() + row * words; }
+    const uint64_t *Row(std::size_t row) const { return data.data() + row * words; }
+
+    void Set(std::size_t row, std::size_t bit) { data[row * words + bit / 64] |= uint64_t(1) << (bit % 64); }
+    bool Test(std::size_t row, std::size_t bit) const { return data[row * words + bit / 64] >> (bit % 64) & 1; }
+
+    // Adds row "from" of source to row "to", returns true if it changed
+    bool Union(std::size_t to, const Bitsets &source, std::size_t from)
+    {
+        uint64_t *target = Row(to);
+        const uint64_t *added = source.Row(from);
+        uint64_t changed = 0;
+        for (std::size_t w = 0; w < words; w++)
+        {
+            changed |= added[w] & ~target[w];
+            target[w] |= added[w];
+        }
+        return changed != 0;
+    }
+
+  private:
+    std::size_t rows;
+    std::size_t words;
+    std::vector<uint64_t> data;
+};
+
+#endif //__BITSETS__H__
@@ -0,0 +1,182 @@
+/*
+ * Conversion to Chomsky Normal Form.
+ */
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "cnf.h"
+
+using namespace std;
+
+// While converting, terminal t is stored as ~t so it cannot be mistaken
+// for a non terminal
+static bool isTerminal(int symbol)
+{
+    return symbol < 0;
+}
+
+struct CnfRule
+{
+    int lhs;
+    vector<int> rhs;
+};
+
+CnfGrammar toCnf(const CharacterType &c, const vector<Rule> &rules)
+{
+    CnfGrammar grammar;
+    if (c.non_terminals.empty())
+        return grammar;
+
+    // IDs never contain ' or _, so the new names cannot clash with them
+    unordered_map<string, int> ids;
+    for (const string &terminal : c.terminals)
+    {
+        if (terminal != "#")
+        {
+            ids.emplace(terminal, ~(int)grammar.terminals.size());
+            grammar.terminals.push_back(terminal);
+        }
+    }
+    grammar.non_terminals.push_back(c.non_terminals[0] + "'");
+    for (const string &non_terminal : c.non_terminals)
+    {
+        ids.emplace(non_terminal, grammar.non_terminals.size());
+        grammar.non_terminals.push_back(non_terminal);
+    }
+    auto newNonTerminal = [&grammar](const string &name)
+    {
+        grammar.non_terminals.push_back(name);
+        return (int)grammar.non_terminals.size() - 1;
+    };
+
+    // New start symbol, terminals of long rules and long rules split up
+    vector<CnfRule> work = {{0, {ids.at(c.non_terminals[0])}}};
+    vector<int> terminal_symbol(grammar.terminals.size(), -1);
+    vector<int> chain_count(grammar.non_terminals.size(), 0);
+    for (const Rule &rule : rules)
+    {
+        vector<int> rhs;
+        for (const string &symbol : rule.rhs)
+        {
+            if (symbol != "#")
+                rhs.push_back(ids.at(symbol));
+        }
+        if (rhs.size() >= 2)
+        {
+            for (int &symbol : rhs)
+            {
+                if (!isTerminal(symbol))
+                    continue;
+                int &replacement = terminal_symbol[~symbol];
+                if (replacement < 0)
+                {
+                    replacement = newNonTerminal("T_" + grammar.terminals[~symbol]);
+                    work.push_back({replacement, {symbol}});
+                }
+                symbol = replacement;
+            }
+        }
+        int lhs = ids.at(rule.lhs);
+        size_t k = 0;
+        while (rhs.size() - k > 2)
+        {
+            int next = newNonTerminal(rule.lhs + "_" + to_string(++chain_count[ids.at(rule.lhs)]));
+            work.push_back({lhs, {rhs[k], next}});
+            lhs = next;
+            k++;
+        }
+        work.push_back({lhs, vector<int>(rhs.begin() + k, rhs.end())});
+    }
+    int count = grammar.non_terminals.size();
+
+    // Nullable non terminals, then epsilon rules replaced by the variants
+    // of the rules that use a nullable symbol
+    vector<bool> nullable(count, false);
+    for (bool changed = true; changed;)
+    {
+        changed = false;
+        for (const CnfRule &rule : work)
+        {
+            if (nullable[rule.lhs])
+                continue;
+            bool all_nullable = true;
+            for (int symbol : rule.rhs)
+                all_nullable = all_nullable && !isTerminal(symbol) && nullable[symbol];
+            if (all_nullable)
+                nullable[rule.lhs] = changed = true;
+        }
+    }
+    grammar.accepts_empty = nullable[0];
+
+    vector<vector<int>> units(count);                 // A -> B
+    vector<vector<pair<int, int>>> binaries(count);   // A -> B C
+    vector<vector<int>> terminals_of(count);          // A -> a
+    for (const CnfRule &rule : work)
+    {
+        const vector<int> &rhs = rule.rhs;
+        if (rhs.size() == 2)
+        {
+            binaries[rule.lhs].push_back({rhs[0], rhs[1]});
+            if (nullable[rhs[0]])
+                units[rule.lhs].push_back(rhs[1]);
+            if (nullable[rhs[1]])
+                units[rule.lhs].push_back(rhs[0]);
+        }
+        else if (rhs.size() == 1 && isTerminal(rhs[0]))
+            terminals_of[rule.lhs].push_back(~rhs[0]);
+        else if (rhs.size() == 1 && rhs[0] != rule.lhs)
+            units[rule.lhs].push_back(rhs[0]);
+    }
+
+    // Unit rules: A gets the rules of every B it derives through unit rules
+    unordered_set<uint64_t> binary_seen;
+    unordered_set<uint64_t> terminal_seen;
+    vector<int> reached(count, -1);
+    vector<int> stack;
+    for (int a = 0; a < count; a++)
+    {
+        stack.push_back(a);
+        reached[a] = a;
+        while (!stack.empty())
+        {
+            int b = stack.back();
+            stack.pop_back();
+            for (const auto &binary : binaries[b])
+            {
+                uint64_t key = (uint64_t)a << 42 | (uint64_t)binary.first << 21 | binary.second;
+                if (binary_seen.insert(key).second)
+                    grammar.binary_rules.push_back({a, binary.first, binary.second});
+            }
+            for (int terminal : terminals_of[b])
+            {
+                if (terminal_seen.insert((uint64_t)a << 32 | terminal).second)
+                    grammar.terminal_rules.push_back({a, terminal});
+            }
+            for (int next : units[b])
+            {
+                if (reached[next] != a)
+                {
+                    reached[next] = a;
+                    stack.push_back(next);
+                }
+            }
+        }
+    }
+    return grammar;
+}
+
+vector<Rule> CnfGrammar::ToRules() const
+{
+    vector<Rule> rules;
+    if (accepts_empty)
+        rules.push_back({non_terminals[0], {"#"}});
+    for (const Binary &rule : binary_rules)
+        rules.push_back({non_terminals[rule.lhs], {non_terminals[rule.left], non_terminals[rule.right]}});
+    for (const Terminal &rule : terminal_rules)
+        rules.push_back({non_terminals[rule.lhs], {terminals[rule.terminal]}});
+    return rules;
+}
@@ -0,0 +1,48 @@
+/*
+ * Conversion to Chomsky Normal Form.
+ *
+ * Every rule of the result is A -> B C or A -> a, over interned symbol
+ * IDs; the empty sentence is recorded as a flag instead of a rule. The
+ * steps are the usual ones: a new start symbol S' -> S, terminals in long
+ * rules replaced by T_a -> a, long rules split into chains of binary
+ * rules, epsilon rules removed (keeping both variants of binary rules
+ * with a nullable symbol) and unit rules removed by adding the rules of
+ * every non terminal A derives through unit rules to A.
+ */
+#ifndef __CNF__H__
+#define __CNF__H__
+
+#include <string>
+#include <vector>
+
+#include "project2.h"
+
+struct CnfGrammar
+{
+    // Terminals are 0 .. terminals.size() - 1, non terminals are numbered
+    // separately from 0, the start symbol is non terminal 0
+    std::vector<std::string> terminals;
+    std::vector<std::string> non_terminals;
+    bool accepts_empty = false;
+
+    struct Binary
+    {
+        int lhs;
+        int left;
+        int right;
+    };
+    struct Terminal
+    {
+        int lhs;
+        int terminal;
+    };
+    std::vector<Binary> binary_rules;
+    std::vector<Terminal> terminal_rules;
+
+    // The rules in the format of readGrammar, for printing
+    std::vector<Rule> ToRules() const;
+};
+
+CnfGrammar toCnf(const CharacterType &c, const std::vector<Rule> &rules);
+
+#endif //__CNF__H__
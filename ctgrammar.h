@@ -0,0 +1,370 @@
+/*
+ * Compile-time FIRST & FOLLOW sets for small embedded grammars.
+ *
+ * Header only. Mirrors findFirstSets/findFollowSets from project2.cc:
+ *   - a symbol is a non-terminal iff it appears on the LHS of some rule
+ *   - terminals and non-terminals are numbered in order of appearance
+ *     (the same order fetchTypes produces)
+ *   - "#" (or an empty RHS) is epsilon, "$" is added to FOLLOW of the
+ *     LHS of the first rule
+ *
+ * Usage:
+ *
+ *   constexpr ctgrammar::Rule<> rules[] = {
+ *       {"S", {"A", "b"}},
+ *       {"A", {"a", "A"}},
+ *       {"A", {"#"}},
+ *   };
+ *   constexpr auto g = ctgrammar::analyze(rules);
+ *   static_assert(g.first(g.nonTerminal("A")).test(g.terminalBit("a")), "");
+ *   static_assert(g.isLL1(), "grammar has an LL(1) conflict");
+ */
+#ifndef __CTGRAMMAR__H__
+#define __CTGRAMMAR__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ctgrammar {
+
+template <std::size_t Bits>
+struct Bitset
+// Fixed size bitset usable in constant expressions (std::bitset is not)
+{
+    static constexpr std::size_t kWords = (Bits + 63) / 64;
+    std::uint64_t words[kWords] = {};
+
+    constexpr bool test(std::size_t i) const
+    {
+        return (words[i / 64] >> (i % 64)) & 1u;
+    }
+
+    constexpr void set(std::size_t i)
+    {
+        words[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+
+    constexpr void reset(std::size_t i)
+    {
+        words[i / 64] &= ~(std::uint64_t(1) << (i % 64));
+    }
+
+    constexpr bool merge(const Bitset &other)
+    // Adds every bit of other, returns true if anything was added
+    {
+        bool changed = false;
+        for (std::size_t w = 0; w < kWords; w++)
+        {
+            std::uint64_t merged = words[w] | other.words[w];
+            changed = changed || merged != words[w];
+            words[w] = merged;
+        }
+        return changed;
+    }
+
+    constexpr bool intersects(const Bitset &other) const
+    {
+        for (std::size_t w = 0; w < kWords; w++)
+        {
+            if (words[w] & other.words[w])
+                return true;
+        }
+        return false;
+    }
+
+    constexpr std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (std::size_t w = 0; w < kWords; w++)
+        {
+            for (std::uint64_t x = words[w]; x; x &= x - 1)
+                n++;
+        }
+        return n;
+    }
+
+    constexpr bool operator==(const Bitset &other) const
+    {
+        for (std::size_t w = 0; w < kWords; w++)
+        {
+            if (words[w] != other.words[w])
+                return false;
+        }
+        return true;
+    }
+};
+
+template <std::size_t MaxRhs = 16>
+struct Rule
+// Rule LHS -> RHS, unused RHS slots are left empty
+{
+    std::string_view lhs;
+    std::string_view rhs[MaxRhs];
+};
+
+template <std::size_t NRules, std::size_t MaxRhs>
+class Grammar
+{
+  public:
+    // Every symbol occurrence could be distinct
+    static constexpr std::size_t kMaxSymbols = NRules * (MaxRhs + 1);
+    // Bit layout of a set: epsilon, end of input, then terminals
+    static constexpr std::size_t kEpsilonBit = 0;
+    static constexpr std::size_t kEndBit = 1;
+    static constexpr std::size_t npos = std::size_t(-1);
+
+    typedef Bitset<kMaxSymbols + 2> Set;
+
+    constexpr explicit Grammar(const Rule<MaxRhs> (&rules)[NRules])
+    {
+        fetchTypes(rules);
+        findFirstSets();
+        findFollowSets();
+    }
+
+    constexpr std::size_t terminalCount() const { return terminal_count; }
+    constexpr std::size_t nonTerminalCount() const { return non_terminal_count; }
+    constexpr std::size_t ruleCount() const { return NRules; }
+    constexpr std::string_view terminalName(std::size_t t) const { return terminals[t]; }
+    constexpr std::string_view nonTerminalName(std::size_t nt) const { return non_terminals[nt]; }
+
+    constexpr std::size_t terminal(std::string_view name) const
+    // Index of a terminal, npos if unknown
+    {
+        for (std::size_t t = 0; t < terminal_count; t++)
+        {
+            if (terminals[t] == name)
+                return t;
+        }
+        return npos;
+    }
+
+    constexpr std::size_t nonTerminal(std::string_view name) const
+    // Index of a non-terminal, npos if unknown
+    {
+        for (std::size_t nt = 0; nt < non_terminal_count; nt++)
+        {
+            if (non_terminals[nt] == name)
+                return nt;
+        }
+        return npos;
+    }
+
+    constexpr std::size_t terminalBit(std::string_view name) const
+    // Position of a symbol inside a Set, accepts "#" and "$" as well
+    {
+        if (name == "#")
+            return kEpsilonBit;
+        if (name == "$")
+            return kEndBit;
+        std::size_t t = terminal(name);
+        return t == npos ? npos : t + 2;
+    }
+
+    constexpr const Set &first(std::size_t nt) const { return first_sets[nt]; }
+    constexpr const Set &follow(std::size_t nt) const { return follow_sets[nt]; }
+    constexpr bool nullable(std::size_t nt) const { return first_sets[nt].test(kEpsilonBit); }
+    constexpr int firstPasses() const { return first_passes; }
+    constexpr int followPasses() const { return follow_passes; }
+
+    constexpr Set firstOfRule(std::size_t r) const
+    // FIRST of the whole RHS of rule r, contains epsilon if the RHS is nullable
+    {
+        return firstOfSuffix(r, 0);
+    }
+
+    constexpr bool isLL1() const
+    // True if no two rules of the same non-terminal conflict on FIRST/FOLLOW
+    {
+        for (std::size_t a = 0; a < NRules; a++)
+        {
+            for (std::size_t b = a + 1; b < NRules; b++)
+            {
+                if (rule_lhs[a] == rule_lhs[b] && conflict(a, b))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool conflict(std::size_t a, std::size_t b) const
+    // True if rules a and b (same LHS) cannot be told apart by one token
+    {
+        Set first_a = firstOfRule(a);
+        Set first_b = firstOfRule(b);
+        bool nullable_a = first_a.test(kEpsilonBit);
+        bool nullable_b = first_b.test(kEpsilonBit);
+        if (nullable_a && nullable_b)
+            return true;
+        first_a.reset(kEpsilonBit);
+        first_b.reset(kEpsilonBit);
+        if (first_a.intersects(first_b))
+            return true;
+        const Set &follow_lhs = follow_sets[rule_lhs[a]];
+        if (nullable_a && first_b.intersects(follow_lhs))
+            return true;
+        if (nullable_b && first_a.intersects(follow_lhs))
+            return true;
+        return false;
+    }
+
+  private:
+    std::string_view terminals[kMaxSymbols] = {};
+    std::string_view non_terminals[kMaxSymbols] = {};
+    std::size_t terminal_count = 0;
+    std::size_t non_terminal_count = 0;
+
+    // Rules with every symbol replaced by its index. RHS symbols use the
+    // bit layout of Set for terminals and kSymNonTerminal + index otherwise
+    static constexpr std::size_t kSymNonTerminal = kMaxSymbols + 2;
+    std::size_t rule_lhs[NRules] = {};
+    std::size_t rule_rhs[NRules][MaxRhs] = {};
+    std::size_t rule_size[NRules] = {};
+
+    Set first_sets[kMaxSymbols] = {};
+    Set follow_sets[kMaxSymbols] = {};
+    int first_passes = 0;
+    int follow_passes = 0;
+
+    static constexpr std::size_t rhsSize(const Rule<MaxRhs> &rule)
+    {
+        std::size_t n = 0;
+        while (n < MaxRhs && !rule.rhs[n].empty())
+            n++;
+        return n;
+    }
+
+    static constexpr bool isLhs(const Rule<MaxRhs> (&rules)[NRules], std::string_view symbol)
+    {
+        for (std::size_t r = 0; r < NRules; r++)
+        {
+            if (rules[r].lhs == symbol)
+                return true;
+        }
+        return false;
+    }
+
+    constexpr std::size_t addNonTerminal(std::string_view name)
+    {
+        std::size_t nt = nonTerminal(name);
+        if (nt != npos)
+            return nt;
+        non_terminals[non_terminal_count] = name;
+        return non_terminal_count++;
+    }
+
+    constexpr std::size_t addTerminal(std::string_view name)
+    {
+        std::size_t t = terminal(name);
+        if (t != npos)
+            return t;
+        terminals[terminal_count] = name;
+        return terminal_count++;
+    }
+
+    constexpr void fetchTypes(const Rule<MaxRhs> (&rules)[NRules])
+    // Same classification and ordering as fetchTypes in project2.cc
+    {
+        for (std::size_t r = 0; r < NRules; r++)
+        {
+            rule_lhs[r] = addNonTerminal(rules[r].lhs);
+            std::size_t n = rhsSize(rules[r]);
+            for (std::size_t k = 0; k < n; k++)
+            {
+                std::string_view symbol = rules[r].rhs[k];
+                if (symbol == "#")
+                    continue;
+                if (isLhs(rules, symbol))
+                    rule_rhs[r][rule_size[r]++] = kSymNonTerminal + addNonTerminal(symbol);
+                else
+                    rule_rhs[r][rule_size[r]++] = addTerminal(symbol) + 2;
+            }
+        }
+    }
+
+    constexpr Set firstOfSuffix(std::size_t r, std::size_t from) const
+    // FIRST of rule_rhs[r][from..], epsilon included if the suffix is nullable
+    {
+        Set result;
+        for (std::size_t k = from; k < rule_size[r]; k++)
+        {
+            std::size_t symbol = rule_rhs[r][k];
+            if (symbol < kSymNonTerminal)
+            {
+                result.set(symbol);
+                return result;
+            }
+            const Set &first_nt = first_sets[symbol - kSymNonTerminal];
+            result.merge(first_nt);
+            result.reset(kEpsilonBit);
+            if (!first_nt.test(kEpsilonBit))
+                return result;
+        }
+        result.set(kEpsilonBit);
+        return result;
+    }
+
+    constexpr void findFirstSets()
+    {
+        bool changed = true;
+        while (changed)
+        // Keep going as long as any first set changes
+        {
+            changed = false;
+            first_passes++;
+            for (std::size_t r = 0; r < NRules; r++)
+            {
+                if (first_sets[rule_lhs[r]].merge(firstOfSuffix(r, 0)))
+                    changed = true;
+            }
+        }
+    }
+
+    constexpr void findFollowSets()
+    {
+        if (non_terminal_count)
+            follow_sets[0].set(kEndBit);
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            follow_passes++;
+            for (std::size_t r = 0; r < NRules; r++)
+            {
+                // What can follow position k, walking the RHS backwards
+                Set trailer = follow_sets[rule_lhs[r]];
+                for (std::size_t k = rule_size[r]; k-- > 0;)
+                {
+                    std::size_t symbol = rule_rhs[r][k];
+                    if (symbol < kSymNonTerminal)
+                    {
+                        trailer = Set();
+                        trailer.set(symbol);
+                        continue;
+                    }
+                    std::size_t nt = symbol - kSymNonTerminal;
+                    if (follow_sets[nt].merge(trailer))
+                        changed = true;
+
+                    Set first_nt = first_sets[nt];
+                    first_nt.reset(kEpsilonBit);
+                    if (!nullable(nt))
+                        trailer = Set();
+                    trailer.merge(first_nt);
+                }
+            }
+        }
+    }
+};
+
+template <std::size_t NRules, std::size_t MaxRhs>
+constexpr Grammar<NRules, MaxRhs> analyze(const Rule<MaxRhs> (&rules)[NRules])
+{
+    return Grammar<NRules, MaxRhs>(rules);
+}
+
+} // namespace ctgrammar
+
+#endif //__CTGRAMMAR__H__
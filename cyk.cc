@@ -0,0 +1,124 @@
+/*
+ * CYK recognizer over a grammar in Chomsky Normal Form.
+ */
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cyk.h"
+
+using namespace std;
+
+CykRecognizer::CykRecognizer(const CnfGrammar &grammar)
+    : non_terminal_count(grammar.non_terminals.size()), accepts_empty(grammar.accepts_empty),
+      terminal_ids(grammar.terminals), terminal_masks(grammar.terminals.size(), non_terminal_count),
+      right_masks(non_terminal_count, non_terminal_count)
+{
+    for (const CnfGrammar::Terminal &rule : grammar.terminal_rules)
+        terminal_masks.Set(rule.terminal, rule.lhs);
+
+    vector<pair<int, int>> pairs;
+    for (const CnfGrammar::Binary &rule : grammar.binary_rules)
+    {
+        right_masks.Set(rule.left, rule.right);
+        pairs.push_back({rule.left, rule.right});
+    }
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+
+    pair_start.assign(non_terminal_count + 1, 0);
+    for (const auto &p : pairs)
+    {
+        pair_start[p.first + 1]++;
+        pair_right.push_back(p.second);
+    }
+    for (int b = 0; b < non_terminal_count; b++)
+        pair_start[b + 1] += pair_start[b];
+
+    pair_masks = Bitsets(pairs.size(), non_terminal_count);
+    for (const CnfGrammar::Binary &rule : grammar.binary_rules)
+    {
+        auto first = pair_right.begin() + pair_start[rule.left];
+        auto last = pair_right.begin() + pair_start[rule.left + 1];
+        pair_masks.Set(lower_bound(first, last, rule.right) - pair_right.begin(), rule.lhs);
+    }
+}
+
+bool CykRecognizer::Recognize(const vector<string> &words) const
+{
+    size_t n = words.size();
+    if (n == 0)
+        return accepts_empty;
+    if (non_terminal_count == 0)
+        return false;
+
+    // Cells of length len start at row (len - 1) * (n + 1) - (len - 1) * len / 2
+    Bitsets chart(n * (n + 1) / 2, non_terminal_count);
+    auto cell = [n](size_t i, size_t len)
+    { return (len - 1) * (n + 1) - (len - 1) * len / 2 + i; };
+    for (size_t i = 0; i < n; i++)
+    {
+        int id = terminal_ids.Find(words[i]);
+        if (id < 0)
+            return false;
+        chart.Union(cell(i, 1), terminal_masks, id);
+    }
+
+    size_t words_per_row = chart.Words();
+    for (size_t len = 2; len <= n; len++)
+    {
+        for (size_t i = 0; i + len <= n; i++)
+        {
+            size_t target = cell(i, len);
+            for (size_t k = 1; k < len; k++)
+            {
+                const uint64_t *left = chart.Row(cell(i, k));
+                const uint64_t *right = chart.Row(cell(i + k, len - k));
+                for (size_t w = 0; w < words_per_row; w++)
+                {
+                    for (uint64_t bits = left[w]; bits; bits &= bits - 1)
+                    {
+                        int b = w * 64 + __builtin_ctzll(bits);
+                        const uint64_t *rights = right_masks.Row(b);
+                        for (size_t v = 0; v < words_per_row; v++)
+                        {
+                            for (uint64_t found = rights[v] & right[v]; found; found &= found - 1)
+                            {
+                                int c = v * 64 + __builtin_ctzll(found);
+                                auto first = pair_right.begin() + pair_start[b];
+                                auto last = pair_right.begin() + pair_start[b + 1];
+                                chart.Union(target, pair_masks, lower_bound(first, last, c) - pair_right.begin());
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return chart.Test(cell(0, n), 0);
+}
+
+vector<bool> recognizeSentences(const CykRecognizer &recognizer, const Sentences &sentences, int threads)
+{
+    if (threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min<size_t>(threads, max<size_t>(1, sentences.size()));
+
+    vector<char> results(sentences.size());
+    atomic<size_t> next(0);
+    auto work = [&]()
+    {
+        for (size_t s = next++; s < sentences.size(); s = next++)
+            results[s] = recognizer.Recognize(sentences[s]);
+    };
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.emplace_back(work);
+    work();
+    for (thread &worker : workers)
+        worker.join();
+    return vector<bool>(results.begin(), results.end());
+}
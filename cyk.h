@@ -0,0 +1,46 @@
+/*
+ * CYK recognizer over a grammar in Chomsky Normal Form.
+ *
+ * Each chart cell is a bitset of non terminals. Two cells are combined
+ * word by word: for every B in the left cell, the cell on the right is
+ * ANDed with the mask of the C that have a rule A -> B C, and the lhs
+ * masks of the pairs found are ORed into the result. The cost depends on
+ * the sentence length and the number of rules, not on the shape of the
+ * grammar.
+ *
+ * Recognize only reads the recognizer, so recognizeSentences can check
+ * many sentences in parallel against one grammar.
+ */
+#ifndef __CYK__H__
+#define __CYK__H__
+
+#include <string>
+#include <vector>
+
+#include "bitsets.h"
+#include "cnf.h"
+#include "sentences.h"
+#include "terminalhash.h"
+
+class CykRecognizer
+{
+  public:
+    explicit CykRecognizer(const CnfGrammar &grammar);
+
+    bool Recognize(const std::vector<std::string> &words) const;
+
+  private:
+    int non_terminal_count;
+    bool accepts_empty;
+    TerminalHash terminal_ids;
+    Bitsets terminal_masks;        // per terminal: the A with A -> a
+    Bitsets right_masks;           // per B: the C with some A -> B C
+    std::vector<int> pair_start;   // per B, into pair_right and pair_masks
+    std::vector<int> pair_right;   // C of each (B, C), sorted per B
+    Bitsets pair_masks;            // per (B, C): the A with A -> B C
+};
+
+// One result per sentence; threads <= 0 uses every core
+std::vector<bool> recognizeSentences(const CykRecognizer &recognizer, const Sentences &sentences, int threads);
+
+#endif //__CYK__H__
@@ -0,0 +1,252 @@
+/*
+ * Earley recognizer.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "earley.h"
+
+using namespace std;
+
+EarleyRecognizer::EarleyRecognizer(const CharacterType &c, const vector<Rule> &rules, const FirstOfTable &suffixes)
+    : symbol_count(0), terminal_count(0), start(-1)
+{
+    unordered_map<string, int> ids;
+    for (const string &terminal : c.terminals)
+    {
+        if (terminal != "#")
+            ids.emplace(terminal, ids.size());
+    }
+    terminal_count = ids.size();
+    vector<string> terminals(terminal_count);
+    for (const auto &terminal : ids)
+        terminals[terminal.second] = terminal.first;
+    terminal_ids = TerminalHash(terminals);
+    for (const string &non_terminal : c.non_terminals)
+        ids.emplace(non_terminal, ids.size());
+    symbol_count = ids.size();
+    if (c.non_terminals.empty())
+        return;
+    start = ids.at(c.non_terminals[0]);
+
+    // Terminal IDs of the table to ours
+    vector<int> terminal_of(suffixes.SymbolCount());
+    for (size_t id = 0; id < terminal_of.size(); id++)
+        terminal_of[id] = ids.at(suffixes.Symbol(id));
+
+    nullable.assign(symbol_count, false);
+    rules_of.resize(symbol_count - terminal_count);
+    rule_first = Bitsets(rules.size(), terminal_count);
+    for (const Rule &rule : rules)
+    {
+        int r = rule_lhs.size();
+        int lhs = ids.at(rule.lhs);
+        rule_lhs.push_back(lhs);
+        rules_of[lhs - terminal_count].push_back(r);
+        item_base.push_back(next_symbol.size());
+        // A non terminal is nullable if one of its rhs is
+        if (suffixes.SuffixNullable(r, 0))
+            nullable[lhs] = true;
+        // FIRST of the rhs, up to its first symbol that is not nullable
+        for (int terminal : suffixes.SuffixFirst(r, 0))
+            rule_first.Set(r, terminal_of[terminal]);
+
+        for (const string &symbol : rule.rhs)
+        {
+            if (symbol == "#")
+                continue;
+            item_rule.push_back(r);
+            next_symbol.push_back(ids.at(symbol));
+        }
+        item_rule.push_back(r);
+        next_symbol.push_back(-1);
+    }
+}
+
+class EarleyItemSet
+// Open addressing set of (item, origin) keys of the Earley set being built.
+// Clear() is O(1): slots of older sets carry an older generation.
+{
+  public:
+    EarleyItemSet() : generation(1), count(0), keys(1024), generations(1024, 0) {}
+
+    void Clear()
+    {
+        generation++;
+        count = 0;
+    }
+
+    // Returns false if the key was already there
+    bool Insert(uint64_t key)
+    {
+        if (2 * (count + 1) > keys.size())
+            Grow();
+        size_t mask = keys.size() - 1;
+        for (size_t slot = Hash(key) & mask;; slot = (slot + 1) & mask)
+        {
+            if (generations[slot] != generation)
+            {
+                generations[slot] = generation;
+                keys[slot] = key;
+                count++;
+                return true;
+            }
+            if (keys[slot] == key)
+                return false;
+        }
+    }
+
+  private:
+    static size_t Hash(uint64_t key)
+    {
+        key ^= key >> 31;
+        key *= 0x9e3779b97f4a7c15ull;
+        return key ^ (key >> 29);
+    }
+
+    void Grow()
+    {
+        vector<uint64_t> old_keys;
+        vector<uint32_t> old_generations(keys.size() * 2, 0);
+        old_keys.swap(keys);
+        old_generations.swap(generations);
+        keys.resize(old_keys.size() * 2);
+        uint32_t old_generation = generation;
+        generation = 1;
+        count = 0;
+        for (size_t slot = 0; slot < old_keys.size(); slot++)
+        {
+            if (old_generations[slot] == old_generation)
+                Insert(old_keys[slot]);
+        }
+    }
+
+    uint32_t generation;
+    size_t count;
+    vector<uint64_t> keys;
+    vector<uint32_t> generations;
+};
+
+bool EarleyRecognizer::Recognize(const vector<string> &words, size_t *items) const
+{
+    if (items)
+        *items = 0;
+    if (start < 0)
+        return false;
+    vector<int> tokens;
+    tokens.reserve(words.size());
+    for (const string &word : words)
+    {
+        int id = terminal_ids.Find(word);
+        if (id < 0)
+            return false;
+        tokens.push_back(id);
+    }
+    size_t n = tokens.size();
+
+    // The items of set i are item[set_start[i]] up to item[set_start[i + 1]]
+    vector<int> item;
+    vector<int> origin;
+    vector<size_t> set_start(1, 0);
+    // Per finished set, the items waiting for each symbol, sorted by symbol
+    vector<size_t> waiting_start(1, 0);
+    vector<pair<int, int>> waiting;
+    EarleyItemSet added;
+    vector<int> predicted(symbol_count - terminal_count, -1);
+
+    auto add = [&](int new_item, int new_origin)
+    {
+        if (added.Insert((uint64_t)new_item << 32 | (uint32_t)new_origin))
+        {
+            item.push_back(new_item);
+            origin.push_back(new_origin);
+        }
+    };
+    auto waitingFor = [&](size_t set, int symbol)
+    {
+        auto first = waiting.begin() + waiting_start[set];
+        auto last = waiting.begin() + waiting_start[set + 1];
+        first = lower_bound(first, last, make_pair(symbol, -1));
+        return make_pair(first, upper_bound(first, last, make_pair(symbol, (int)item.size())));
+    };
+
+    for (size_t i = 0; i <= n; i++)
+    {
+        int lookahead = i < n ? tokens[i] : -1;
+        auto predict = [&](int symbol)
+        {
+            if (predicted[symbol - terminal_count] == (int)i)
+                return;
+            predicted[symbol - terminal_count] = i;
+            if (lookahead < 0)
+                return;
+            for (int r : rules_of[symbol - terminal_count])
+            {
+                if (rule_first.Test(r, lookahead))
+                    add(item_base[r], i);
+            }
+        };
+        if (i == 0)
+            predict(start);
+
+        for (size_t k = set_start[i]; k < item.size(); k++)
+        {
+            int current = item[k];
+            int symbol = next_symbol[current];
+            if (symbol < 0)
+            {
+                // Completions with origin i are empty derivations, already
+                // stepped over when their lhs was predicted
+                if (origin[k] == (int)i)
+                    continue;
+                auto range = waitingFor(origin[k], rule_lhs[item_rule[current]]);
+                for (auto it = range.first; it != range.second; ++it)
+                    add(item[it->second] + 1, origin[it->second]);
+            }
+            else if (symbol >= terminal_count)
+            {
+                predict(symbol);
+                if (nullable[symbol])
+                    add(current + 1, origin[k]);
+            }
+        }
+
+        size_t set_end = item.size();
+        for (size_t k = set_start[i]; k < set_end; k++)
+        {
+            if (next_symbol[item[k]] >= 0)
+                waiting.push_back({next_symbol[item[k]], (int)k});
+        }
+        sort(waiting.begin() + waiting_start[i], waiting.end());
+        waiting_start.push_back(waiting.size());
+        set_start.push_back(set_end);
+        if (i == n)
+            break;
+
+        added.Clear();
+        auto range = waitingFor(i, tokens[i]);
+        for (auto it = range.first; it != range.second; ++it)
+            add(item[it->second] + 1, origin[it->second]);
+        if (item.size() == set_end)
+        {
+            if (items)
+                *items = item.size();
+            return false;
+        }
+    }
+
+    if (items)
+        *items = item.size();
+    if (n == 0)
+        return nullable[start];
+    for (size_t k = set_start[n]; k < item.size(); k++)
+    {
+        if (next_symbol[item[k]] < 0 && origin[k] == 0 && rule_lhs[item_rule[item[k]]] == start)
+            return true;
+    }
+    return false;
+}
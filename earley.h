@@ -0,0 +1,52 @@
+/*
+ * Earley recognizer.
+ *
+ * Works on any grammar readGrammar accepts: ambiguous, left recursive or
+ * with epsilon rules. Symbols are interned to integers and an Earley item
+ * is a packed (rule, dot) integer plus its origin; the items of every
+ * position live in one flat array. Prediction only adds the rules whose
+ * FIRST set contains the next word, and nullable non terminals are
+ * stepped over when they are predicted (Aycock and Horspool), so
+ * completion never has to revisit the current set.
+ *
+ * Recognize only reads the recognizer, so one recognizer can be shared by
+ * several threads.
+ */
+#ifndef __EARLEY__H__
+#define __EARLEY__H__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bitsets.h"
+#include "firstof.h"
+#include "project2.h"
+#include "terminalhash.h"
+
+class EarleyRecognizer
+{
+  public:
+    // suffixes is the FirstOfTable of the same rules; only FIRST and
+    // nullability of each whole rhs are used
+    EarleyRecognizer(const CharacterType &c, const std::vector<Rule> &rules, const FirstOfTable &suffixes);
+
+    // items, if given, is set to the number of Earley items created
+    bool Recognize(const std::vector<std::string> &words, std::size_t *items = nullptr) const;
+
+  private:
+    int symbol_count;
+    int terminal_count;
+    int start;
+    TerminalHash terminal_ids;
+    std::vector<bool> nullable;
+
+    std::vector<int> rule_lhs;
+    std::vector<int> item_base;   // per rule
+    std::vector<int> item_rule;   // per item
+    std::vector<int> next_symbol; // per item, -1 at the end
+    std::vector<std::vector<int>> rules_of; // per non terminal
+    Bitsets rule_first; // FIRST of each rhs, over terminal IDs
+};
+
+#endif //__EARLEY__H__
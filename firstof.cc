@@ -0,0 +1,150 @@
+/*
+ * FIRST of symbol strings.
+ */
+#include <string>
+#include <vector>
+
+#include "firstof.h"
+
+using namespace std;
+
+FirstOfTable::FirstOfTable(const vector<Rule> &rules, const Fsets &first_sets)
+{
+    vector<char> seen;
+    rule_start.reserve(rules.size());
+    for (const Rule &rule : rules)
+    {
+        const vector<string> &rhs = rule.rhs;
+        size_t start = positions.size();
+        rule_start.push_back(start);
+        positions.resize(start + rhs.size() + 1);
+        positions[start + rhs.size()] = {0, 0, true, true}; // empty suffix
+
+        for (size_t i = rhs.size(); i-- > 0;)
+        {
+            const SymbolFirst &symbol = FirstOfSymbol(first_sets, rhs[i]);
+            const Position next = positions[start + i + 1];
+            Position &position = positions[start + i];
+            if (!symbol.nullable || next.size == 0)
+            {
+                position = {symbol.offset, symbol.size, true, symbol.nullable && next.nullable};
+                continue;
+            }
+
+            // FIRST(rhs[i]) followed by whatever FIRST(rhs[i+1..]) adds
+            seen.resize(symbols.size());
+            size_t offset = rule_pool.size();
+            for (size_t k = 0; k < symbol.size; k++)
+            {
+                int id = symbol_pool[symbol.offset + k];
+                seen[id] = 1;
+                rule_pool.push_back(id);
+            }
+            const vector<int> &next_pool = next.shared ? symbol_pool : rule_pool;
+            for (size_t k = 0; k < next.size; k++)
+            {
+                int id = next_pool[next.offset + k];
+                if (!seen[id])
+                    rule_pool.push_back(id);
+            }
+            for (size_t k = 0; k < symbol.size; k++)
+                seen[symbol_pool[symbol.offset + k]] = 0;
+            position = {offset, rule_pool.size() - offset, false, next.nullable};
+        }
+    }
+
+    // Symbols that are in no rhs, for First()
+    for (const auto &set : first_sets)
+        FirstOfSymbol(first_sets, set.first);
+}
+
+int FirstOfTable::Intern(const string &symbol)
+{
+    auto it = ids.find(symbol);
+    if (it != ids.end())
+        return it->second;
+    int id = symbols.size();
+    symbols.push_back(symbol);
+    ids.emplace(symbol, id);
+    return id;
+}
+
+const FirstOfTable::SymbolFirst &FirstOfTable::FirstOfSymbol(const Fsets &first_sets, const string &symbol)
+// FIRST set of one symbol as IDs in symbol_pool, built once per symbol
+{
+    auto it = symbol_first.find(symbol);
+    if (it != symbol_first.end())
+        return it->second;
+
+    SymbolFirst first = {symbol_pool.size(), 0, false};
+    auto set = first_sets.find(symbol);
+    if (set != first_sets.end())
+    {
+        for (const string &element : set->second)
+        {
+            if (element == "#")
+                first.nullable = true;
+            else
+                symbol_pool.push_back(Intern(element));
+        }
+    }
+    first.size = symbol_pool.size() - first.offset;
+    return symbol_first.emplace(symbol, first).first->second;
+}
+
+FirstOfTable::Span FirstOfTable::SuffixFirst(size_t rule, size_t position) const
+{
+    const Position &p = positions[rule_start[rule] + position];
+    const vector<int> &pool = p.shared ? symbol_pool : rule_pool;
+    const int *data = pool.data() + p.offset;
+    return {data, data + p.size};
+}
+
+bool FirstOfTable::SuffixNullable(size_t rule, size_t position) const
+{
+    return positions[rule_start[rule] + position].nullable;
+}
+
+vector<string> FirstOfTable::First(const vector<string> &alpha) const
+{
+    vector<string> result;
+    vector<char> seen(symbols.size(), 0);
+    bool nullable = true;
+    for (const string &symbol : alpha)
+    {
+        auto first = symbol_first.find(symbol);
+        if (first == symbol_first.end())
+        {
+            nullable = false;
+            break;
+        }
+        const SymbolFirst &set = first->second;
+        for (size_t k = 0; k < set.size; k++)
+        {
+            int id = symbol_pool[set.offset + k];
+            if (!seen[id])
+            {
+                seen[id] = 1;
+                result.push_back(symbols[id]);
+            }
+        }
+        if (!set.nullable)
+        {
+            nullable = false;
+            break;
+        }
+    }
+    if (nullable)
+        result.insert(result.begin(), "#");
+    return result;
+}
+
+const string &FirstOfTable::Symbol(int id) const
+{
+    return symbols[id];
+}
+
+size_t FirstOfTable::SymbolCount() const
+{
+    return symbols.size();
+}
@@ -0,0 +1,82 @@
+/*
+ * FIRST of symbol strings.
+ *
+ * FirstOfTable stores FIRST(rhs[i..]) and whether rhs[i..] is nullable for
+ * every position i of every rule, built in one backward sweep per rule
+ * from the FIRST sets of single symbols. FOLLOW construction (and anything
+ * else that needs FIRST(alpha) for a rule suffix) looks the sets up instead
+ * of rebuilding them, which is quadratic in the RHS length.
+ *
+ * Suffix sets keep the order the forward construction produces: the FIRST
+ * set of rhs[i] in its own order, then the new elements of the rest.
+ *
+ * The table copies the sets it is built from as terminal IDs, so the Fsets
+ * can be changed or dropped afterwards.
+ */
+#ifndef __FIRSTOF__H__
+#define __FIRSTOF__H__
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "project2.h"
+
+class FirstOfTable
+{
+  public:
+    // Terminal IDs of one FIRST set, never containing "#"
+    struct Span
+    {
+        const int *first;
+        const int *last;
+
+        const int *begin() const { return first; }
+        const int *end() const { return last; }
+        std::size_t size() const { return last - first; }
+    };
+
+    FirstOfTable(const std::vector<Rule> &rules, const Fsets &first_sets);
+
+    // position can be rules[rule].rhs.size(), the empty suffix
+    Span SuffixFirst(std::size_t rule, std::size_t position) const;
+    bool SuffixNullable(std::size_t rule, std::size_t position) const;
+
+    // FIRST(alpha) for any string of symbols, with "#" in front if alpha
+    // derives epsilon (the same layout as the sets of findFirstSets)
+    std::vector<std::string> First(const std::vector<std::string> &alpha) const;
+
+    const std::string &Symbol(int id) const;
+    // IDs are 0 to SymbolCount() - 1
+    std::size_t SymbolCount() const;
+
+  private:
+    struct Position
+    {
+        std::size_t offset; // into symbol_pool if shared, else rule_pool
+        std::size_t size;
+        bool shared;
+        bool nullable;
+    };
+
+    struct SymbolFirst
+    {
+        std::size_t offset; // into symbol_pool
+        std::size_t size;
+        bool nullable;
+    };
+
+    const SymbolFirst &FirstOfSymbol(const Fsets &first_sets, const std::string &symbol);
+    int Intern(const std::string &symbol);
+
+    std::vector<std::string> symbols;
+    std::unordered_map<std::string, int> ids;
+    std::unordered_map<std::string, SymbolFirst> symbol_first;
+    std::vector<int> symbol_pool;
+    std::vector<int> rule_pool;
+    std::vector<std::size_t> rule_start; // first Position of each rule
+    std::vector<Position> positions;
+};
+
+#endif //__FIRSTOF__H__
@@ -0,0 +1,248 @@
+/*
+ * A grammar and everything computed from it.
+ */
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "grammarcontext.h"
+#include "output.h"
+#include "stats.h"
+
+using namespace std;
+
+GrammarContext::GrammarContext() : sentences_loaded(false), threads(0), format(OUTPUT_TEXT), task5_order(TASK5_ORDER_LEXICOGRAPHIC), max_lookahead(LLK_MAX_K), loaded(false), types_done(false), first_done(false), follow_done(false)
+{
+}
+
+GrammarStatus GrammarContext::Load(istream &in)
+{
+    rules.clear();
+    types = CharacterType();
+    first_sets.clear();
+    suffix_first_sets.reset();
+    follow_sets.clear();
+    lazy_sets.reset();
+    loaded = types_done = first_done = follow_done = false;
+
+    // The tokens are only needed until the rules are read
+    StatsTimer lex_timer(STATS_LEX);
+    unique_ptr<LexicalAnalyzer> lexer(new LexicalAnalyzer(in, threads));
+    lex_timer.Stop();
+    stats.tokens_lexed = lexer->TokenCount();
+
+    StatsTimer read_timer(STATS_READ_GRAMMAR);
+    bool ok = readGrammar(*lexer, rules);
+    lexer.reset();
+    read_timer.Stop();
+    stats.rules_loaded = rules.size();
+    if (!ok)
+    {
+        rules.clear();
+        return GRAMMAR_SYNTAX_ERROR;
+    }
+    loaded = true;
+    return GRAMMAR_OK;
+}
+
+GrammarStatus GrammarContext::LoadString(const string &grammar)
+{
+    istringstream in(grammar);
+    return Load(in);
+}
+
+bool GrammarContext::Loaded() const
+{
+    return loaded;
+}
+
+void GrammarContext::LoadSentences(istream &in)
+{
+    sentences.clear();
+    readSentences(in, sentences);
+    sentences_loaded = true;
+}
+
+void GrammarContext::SetThreads(int count)
+{
+    threads = count;
+}
+
+void GrammarContext::SetFormat(OutputFormat output_format)
+{
+    format = output_format;
+}
+
+void GrammarContext::SetTask5Order(Task5Order order)
+{
+    task5_order = order;
+}
+
+void GrammarContext::SetTask5Budget(const Task5Budget &budget)
+{
+    task5_budget = budget;
+}
+
+void GrammarContext::SetMaxLookahead(int k)
+{
+    max_lookahead = k;
+}
+
+const Task4Origins &GrammarContext::LastTask4Origins() const
+{
+    return task4_origins;
+}
+
+const Task5Report &GrammarContext::LastTask5Report() const
+{
+    return task5_report;
+}
+
+ReduceReport GrammarContext::Reduce()
+{
+    ReduceReport report = reduceGrammar(rules);
+    types = CharacterType();
+    first_sets.clear();
+    suffix_first_sets.reset();
+    follow_sets.clear();
+    lazy_sets.reset();
+    types_done = first_done = follow_done = false;
+    return report;
+}
+
+const vector<Rule> &GrammarContext::Rules() const
+{
+    return rules;
+}
+
+const CharacterType &GrammarContext::Types()
+{
+    if (!types_done)
+    {
+        types = fetchTypes(rules);
+        types_done = true;
+    }
+    return types;
+}
+
+const Fsets &GrammarContext::FirstSets()
+{
+    if (!first_done)
+    {
+        findFirstSets(Types(), rules, first_sets);
+        first_done = true;
+    }
+    return first_sets;
+}
+
+const FirstOfTable &GrammarContext::SuffixFirstSets()
+{
+    if (!suffix_first_sets)
+        suffix_first_sets.reset(new FirstOfTable(rules, FirstSets()));
+    return *suffix_first_sets;
+}
+
+const Fsets &GrammarContext::FollowSets()
+{
+    if (!follow_done)
+    {
+        const Fsets &first = FirstSets();
+        findFollowSets(Types(), rules, first, SuffixFirstSets(), follow_sets);
+        follow_done = true;
+    }
+    return follow_sets;
+}
+
+LazySets &GrammarContext::Lazy()
+{
+    if (!lazy_sets)
+        lazy_sets.reset(new LazySets(Types(), rules));
+    return *lazy_sets;
+}
+
+GrammarStatus GrammarContext::RunQuery(int task, const vector<string> &symbols, ostream &out)
+{
+    if (task != 2 && task != 3)
+        return GRAMMAR_BAD_TASK;
+    if (!loaded)
+        return GRAMMAR_NOT_LOADED;
+    if (format != OUTPUT_TEXT)
+        return GRAMMAR_BAD_FORMAT;
+
+    OutputWriter output(out);
+    for (const string &symbol : symbols)
+    {
+        const vector<string> *set = task == 2 ? Lazy().First(symbol) : Lazy().Follow(symbol);
+        if (!set)
+            return GRAMMAR_UNKNOWN_SYMBOL;
+        vector<string> sorted = *set;
+        if (task == 2)
+            sortFirstSet(sorted, Types());
+        else
+            sortFollowSet(sorted, Types());
+        printSet(output, task == 2 ? "FIRST" : "FOLLOW", symbol, sorted);
+    }
+    return GRAMMAR_OK;
+}
+
+GrammarStatus GrammarContext::RunTask(int task, ostream &out)
+// The tasks sort and rewrite their own copies of the sets and rules, so the
+// context can run any number of tasks on the same grammar; tasks 2, 3, 6 and
+// 7 use the FIRST and FOLLOW sets computed once per grammar
+{
+    if (task < 1 || task > 9)
+        return GRAMMAR_BAD_TASK;
+    if (!loaded)
+        return GRAMMAR_NOT_LOADED;
+    if (task > 5 && format != OUTPUT_TEXT)
+        return GRAMMAR_BAD_FORMAT;
+    bool task5_budgeted = task5_budget.max_rules > 0 || task5_budget.max_bytes > 0;
+    if (task == 5 && task5_budgeted && format != OUTPUT_TEXT)
+        return GRAMMAR_BAD_FORMAT;
+
+    switch (task)
+    {
+    case 1:
+        Task1(rules, out, format);
+        break;
+    case 2:
+        Task2(Types(), FirstSets(), out, format);
+        break;
+    case 3:
+        Task3(Types(), FollowSets(), out, format);
+        break;
+    case 4:
+        task4_origins.clear();
+        Task4(Types(), rules, out, format, &task4_origins);
+        break;
+    case 5:
+    {
+        task5_report = Task5Report();
+        int result = Task5(Types(), rules, out, format, task5_order, &task5_report, &task5_budget);
+        if (result == 1)
+            return GRAMMAR_EPSILON_RULES;
+        if (result == 2)
+            return GRAMMAR_BUDGET_EXCEEDED;
+        break;
+    }
+    case 6:
+        Task6(Types(), rules, FollowSets(), out);
+        break;
+    case 7:
+        if (!sentences_loaded)
+            return GRAMMAR_NO_SENTENCES;
+        Task7(Types(), rules, SuffixFirstSets(), sentences, out);
+        break;
+    case 8:
+        if (!sentences_loaded)
+            return GRAMMAR_NO_SENTENCES;
+        Task8(Types(), rules, sentences, threads, out);
+        break;
+    case 9:
+        Task9(Types(), rules, max_lookahead, out);
+        break;
+    }
+    return GRAMMAR_OK;
+}
@@ -0,0 +1,111 @@
+/*
+ * A grammar and everything computed from it.
+ *
+ * GrammarContext owns the rules, the terminal/non terminal classification
+ * and the FIRST/FOLLOW sets of one grammar; the tokens of the lexer are
+ * freed as soon as the rules are read. Nothing is
+ * shared between contexts, so several grammars can be loaded and analyzed
+ * at the same time, one context per thread. Errors are returned as a
+ * GrammarStatus instead of ending the process.
+ */
+#ifndef __GRAMMARCONTEXT__H__
+#define __GRAMMARCONTEXT__H__
+
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "firstof.h"
+#include "lazysets.h"
+#include "lexer.h"
+#include "llk.h"
+#include "project2.h"
+#include "reduce.h"
+
+typedef enum {
+    GRAMMAR_OK = 0,
+    GRAMMAR_SYNTAX_ERROR,
+    GRAMMAR_EPSILON_RULES, // Task5 printed the rules but cannot factor them
+    GRAMMAR_BAD_TASK,
+    GRAMMAR_NOT_LOADED,
+    GRAMMAR_NO_SENTENCES, // recognizer task without sentences
+    GRAMMAR_UNKNOWN_SYMBOL,
+    GRAMMAR_BAD_FORMAT, // JSON or binary output from a task that only writes text
+    GRAMMAR_BUDGET_EXCEEDED // Task5 stopped at its budget, see LastTask5Report()
+} GrammarStatus;
+
+class GrammarContext
+{
+  public:
+    GrammarContext();
+
+    // Replaces whatever grammar was loaded before
+    GrammarStatus Load(std::istream &in);
+    GrammarStatus LoadString(const std::string &grammar);
+    bool Loaded() const;
+    // Sentences for the recognizer tasks
+    void LoadSentences(std::istream &in);
+    // Threads lexing of large inputs and task 8 may use, <= 0 for every
+    // core; set it before Load()
+    void SetThreads(int count);
+    // Output of task 1 to 5, text by default (see structured.h)
+    void SetFormat(OutputFormat output_format);
+    // Elimination order of task 5, lexicographic by default
+    void SetTask5Order(Task5Order order);
+    // Limits on what task 5 holds in memory, none by default; with a limit
+    // task 5 prints rules as soon as they are final and writes text only
+    void SetTask5Budget(const Task5Budget &budget);
+    // Largest k task 9 tries, 1 to LLK_MAX_K (the default)
+    void SetMaxLookahead(int k);
+    // Drops useless symbols and rules (see reduce.h) before any analysis
+    ReduceReport Reduce();
+
+    const std::vector<Rule> &Rules() const;
+    // Computed on first use, in the same order the tasks compute them
+    const CharacterType &Types();
+    const Fsets &FirstSets();
+    // FIRST(rhs[i..]) of every rule position, also used for FollowSets()
+    const FirstOfTable &SuffixFirstSets();
+    const Fsets &FollowSets();
+    // Sets of single symbols, computed only as far as they need
+    LazySets &Lazy();
+
+    // Runs task 1 to 9 and writes its output to out
+    GrammarStatus RunTask(int task, std::ostream &out);
+    // The lines of task 2 (FIRST) or task 3 (FOLLOW) for the given symbols
+    // only, from Lazy()
+    GrammarStatus RunQuery(int task, const std::vector<std::string> &symbols, std::ostream &out);
+    // The input non terminal each name the last task 4 made comes from
+    const Task4Origins &LastTask4Origins() const;
+    // Predicted and printed size of the last task 5 output, and the memory
+    // it held
+    const Task5Report &LastTask5Report() const;
+
+  private:
+    GrammarContext(const GrammarContext &) = delete;
+    GrammarContext &operator=(const GrammarContext &) = delete;
+
+    std::vector<Rule> rules;
+    CharacterType types;
+    Fsets first_sets;
+    std::unique_ptr<FirstOfTable> suffix_first_sets;
+    Fsets follow_sets;
+    std::unique_ptr<LazySets> lazy_sets;
+    Sentences sentences;
+    bool sentences_loaded;
+    int threads;
+    OutputFormat format;
+    Task5Order task5_order;
+    Task5Budget task5_budget;
+    Task4Origins task4_origins;
+    Task5Report task5_report;
+    int max_lookahead;
+    bool loaded;
+    bool types_done;
+    bool first_done;
+    bool follow_done;
+};
+
+#endif //__GRAMMARCONTEXT__H__
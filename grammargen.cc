@@ -0,0 +1,122 @@
+/*
+ * Deterministic synthetic grammar generator used by the benchmarks.
+ */
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "grammargen.h"
+
+using namespace std;
+
+uint64_t GrammarRandom::Next()
+{
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+int GrammarRandom::Below(int n)
+{
+    if (n <= 0)
+        return 0;
+    return (int)(Next() % (uint64_t)n);
+}
+
+double GrammarRandom::Unit()
+{
+    return (Next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static string nonTerminalName(int i)
+{
+    return "N" + to_string(i);
+}
+
+static string terminalName(int i)
+{
+    return "t" + to_string(i);
+}
+
+static string randomSymbol(GrammarRandom &random, const GrammarGenParams &params)
+{
+    if (params.terminals > 0 && (params.non_terminals == 0 || random.Below(2) == 0))
+        return terminalName(random.Below(params.terminals));
+    return nonTerminalName(random.Below(params.non_terminals));
+}
+
+static string leadingSymbol(GrammarRandom &random, const GrammarGenParams &params, int i)
+// First symbol of a RHS of Ni that is not meant to be left recursive: a
+// terminal or a non-terminal with a larger index, so the only left recursion
+// is the one requested by left_recursion_depth
+{
+    int higher = params.non_terminals - i - 1;
+    if (params.terminals > 0 && (higher <= 0 || random.Below(2) == 0))
+        return terminalName(random.Below(params.terminals));
+    if (higher <= 0)
+        return nonTerminalName(i);
+    return nonTerminalName(i + 1 + random.Below(higher));
+}
+
+static int leftRecursionTarget(const GrammarGenParams &params, int i)
+// Non-terminals are grouped in cycles N(g) -> N(g+1) -> .. -> N(g+depth-1) -> N(g)
+{
+    int depth = params.left_recursion_depth;
+    int group = i - i % depth;
+    int next = i + 1;
+    if (next == group + depth || next >= params.non_terminals)
+        next = group;
+    return next;
+}
+
+string generateGrammar(const GrammarGenParams &params)
+{
+    GrammarRandom random(params.seed);
+    string grammar;
+    int max_length = params.rhs_length > 0 ? params.rhs_length : 1;
+
+    for (int i = 0; i < params.non_terminals; i++)
+    {
+        string lhs = nonTerminalName(i);
+
+        vector<string> prefix;
+        if (params.shared_prefix_depth > 0)
+        {
+            prefix.push_back(leadingSymbol(random, params, i));
+            while ((int)prefix.size() < params.shared_prefix_depth)
+                prefix.push_back(randomSymbol(random, params));
+        }
+
+        for (int a = 0; a < params.alternatives; a++)
+        {
+            grammar += lhs + " ->";
+
+            if (a > 0 && random.Unit() < params.epsilon_density)
+            {
+                grammar += " *\n";
+                continue;
+            }
+
+            vector<string> rhs;
+            if (a == 0 && params.left_recursion_depth > 0)
+                rhs.push_back(nonTerminalName(leftRecursionTarget(params, i)));
+            else if (!prefix.empty() && a < params.alternatives - 1)
+                rhs = prefix;
+            else
+                rhs.push_back(leadingSymbol(random, params, i));
+
+            int length = 1 + random.Below(max_length);
+            if (!prefix.empty() && rhs.size() == prefix.size())
+                length = max(length, (int)rhs.size() + 1);
+            while ((int)rhs.size() < length)
+                rhs.push_back(randomSymbol(random, params));
+
+            for (const string &symbol : rhs)
+                grammar += " " + symbol;
+            grammar += " *\n";
+        }
+    }
+    grammar += "#\n";
+    return grammar;
+}
@@ -0,0 +1,40 @@
+/*
+ * Deterministic synthetic grammar generator used by the benchmarks.
+ *
+ * The same parameters (seed included) always produce the same grammar text,
+ * in the input format read by readGrammar.
+ */
+#ifndef __GRAMMARGEN__H__
+#define __GRAMMARGEN__H__
+
+#include <cstdint>
+#include <string>
+
+struct GrammarGenParams
+{
+    std::uint64_t seed = 1;
+    int non_terminals = 10;
+    int terminals = 10;
+    int alternatives = 3;          // rules per non-terminal
+    int rhs_length = 4;            // maximum number of symbols on a RHS
+    double epsilon_density = 0.0;  // probability that a rule is A -> epsilon
+    int left_recursion_depth = 0;  // 0 none, 1 A -> A .., k cycles of k non-terminals
+    int shared_prefix_depth = 0;   // length of the prefix shared by the alternatives of a non-terminal
+};
+
+class GrammarRandom
+// splitmix64, so generated grammars do not depend on the standard library
+{
+  public:
+    explicit GrammarRandom(std::uint64_t seed) : state(seed) {}
+    std::uint64_t Next();
+    int Below(int n);
+    double Unit();
+
+  private:
+    std::uint64_t state;
+};
+
+std::string generateGrammar(const GrammarGenParams &params);
+
+#endif //__GRAMMARGEN__H__
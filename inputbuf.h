@@ -6,11 +6,15 @@
 #ifndef __INPUT_BUFFER__H__
 #define __INPUT_BUFFER__H__
 
+#include <istream>
 #include <string>
 #include <vector>
 
 class InputBuffer {
   public:
+    InputBuffer();
+    explicit InputBuffer(std::istream&);
+
     void GetChar(char&);
     char UngetChar(char);
     std::string UngetString(std::string);
@@ -18,6 +22,7 @@ class InputBuffer {
 
   private:
     std::vector<char> input_buffer;
+    std::istream* in;
 };
 
 #endif  //__INPUT_BUFFER__H__
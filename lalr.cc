@@ -0,0 +1,191 @@
+/*
+ * LALR(1) lookaheads of an LR(0) automaton.
+ */
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+#include "lalr.h"
+
+using namespace std;
+
+struct Relation
+// Adjacency lists of a relation over non terminal transitions
+{
+    vector<int> start;
+    vector<int> edges;
+
+    Relation() = default;
+    Relation(int count, const vector<pair<int, int>> &pairs) : start(count + 1, 0), edges(pairs.size())
+    {
+        for (const auto &edge : pairs)
+            start[edge.first + 1]++;
+        for (int x = 0; x < count; x++)
+            start[x + 1] += start[x];
+        vector<int> next(start.begin(), start.end() - 1);
+        for (const auto &edge : pairs)
+            edges[next[edge.first]++] = edge.second;
+    }
+};
+
+static void digraph(const Relation &relation, Bitsets &sets)
+// F(x) = F'(x) + union of F(y) over x R y, for every x; sets holds F' on
+// entry. Members of a strongly connected component get the same set.
+// Iterative, so long chains of transitions cannot overflow the stack.
+{
+    int count = relation.start.size() - 1;
+    vector<int> depth(count, 0);
+    vector<int> stack;
+    struct Frame
+    {
+        int x;
+        int edge;
+        int depth;
+    };
+    vector<Frame> calls;
+
+    for (int root = 0; root < count; root++)
+    {
+        if (depth[root] != 0)
+            continue;
+        stack.push_back(root);
+        depth[root] = stack.size();
+        calls.push_back({root, relation.start[root], depth[root]});
+        while (!calls.empty())
+        {
+            Frame &frame = calls.back();
+            int x = frame.x;
+            if (frame.edge < relation.start[x + 1])
+            {
+                int y = relation.edges[frame.edge++];
+                if (depth[y] == 0)
+                {
+                    stack.push_back(y);
+                    depth[y] = stack.size();
+                    calls.push_back({y, relation.start[y], depth[y]});
+                }
+                else
+                {
+                    depth[x] = min(depth[x], depth[y]);
+                    sets.Union(x, sets, y);
+                }
+                continue;
+            }
+
+            if (depth[x] == frame.depth)
+            {
+                int top;
+                do
+                {
+                    top = stack.back();
+                    stack.pop_back();
+                    depth[top] = INT_MAX;
+                    if (top != x)
+                        sets.Union(top, sets, x);
+                } while (top != x);
+            }
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                int parent = calls.back().x;
+                depth[parent] = min(depth[parent], depth[x]);
+                sets.Union(parent, sets, x);
+            }
+        }
+    }
+}
+
+Bitsets lalrLookaheads(const LRAutomaton &automaton, LalrRelations *relations)
+{
+    Bitsets lookaheads(automaton.ReductionCount(), automaton.TerminalCount());
+    if (automaton.StateCount() == 0)
+        return lookaheads;
+
+    // Number the non terminal transitions
+    vector<int> transition_of(automaton.TransitionCount(), -1);
+    vector<int> source;
+    vector<int> transition;
+    for (int s = 0; s < automaton.StateCount(); s++)
+    {
+        for (int index = automaton.FirstTransition(s); index < automaton.FirstTransition(s + 1); index++)
+        {
+            if (automaton.IsTerminal(automaton.TransitionSymbol(index)))
+                continue;
+            transition_of[index] = transition.size();
+            source.push_back(s);
+            transition.push_back(index);
+        }
+    }
+    int count = transition.size();
+
+    // DR and reads
+    // (reads is built in order of x, so it goes straight into adjacency lists)
+    Bitsets follow(count, automaton.TerminalCount());
+    Relation reads;
+    for (int x = 0; x < count; x++)
+    {
+        reads.start.push_back(reads.edges.size());
+        int state = automaton.TransitionTarget(transition[x]);
+        for (int index = automaton.FirstTransition(state); index < automaton.FirstTransition(state + 1); index++)
+        {
+            int symbol = automaton.TransitionSymbol(index);
+            if (automaton.IsTerminal(symbol))
+                follow.Set(x, symbol);
+            else if (automaton.Nullable(symbol))
+                reads.edges.push_back(transition_of[index]);
+        }
+    }
+    reads.start.push_back(reads.edges.size());
+    // S' -> S is followed by the end of input
+    int start_symbol = automaton.RuleRhs(automaton.AugmentedRule())[0];
+    int start_transition = automaton.TransitionIndex(0, start_symbol);
+    follow.Set(transition_of[start_transition], 0);
+
+    // includes and lookback, walking every rule of B from p' for each (p', B)
+    vector<pair<int, int>> includes;
+    vector<pair<int, int>> lookback; // (reduction row, transition)
+    vector<bool> nullable_suffix;
+    for (int x = 0; x < count; x++)
+    {
+        int lhs = automaton.TransitionSymbol(transition[x]);
+        for (int rule : automaton.RulesOf(lhs))
+        {
+            LRAutomaton::Span rhs = automaton.RuleRhs(rule);
+            nullable_suffix.assign(rhs.size() + 1, true);
+            for (size_t i = rhs.size(); i-- > 0;)
+                nullable_suffix[i] = nullable_suffix[i + 1] && automaton.Nullable(rhs[i]);
+
+            int state = source[x];
+            for (size_t i = 0; i < rhs.size(); i++)
+            {
+                int index = automaton.TransitionIndex(state, rhs[i]);
+                if (!automaton.IsTerminal(rhs[i]) && nullable_suffix[i + 1])
+                    includes.push_back({transition_of[index], x});
+                state = automaton.TransitionTarget(index);
+            }
+            LRAutomaton::Span reductions = automaton.Reductions(state);
+            size_t k = find(reductions.begin(), reductions.end(), rule) - reductions.begin();
+            lookback.push_back({automaton.ReductionIndex(state) + (int)k, x});
+        }
+    }
+
+    digraph(reads, follow);
+    digraph(Relation(count, includes), follow);
+
+    for (const auto &edge : lookback)
+        lookaheads.Union(edge.first, follow, edge.second);
+    int accept_state = automaton.TransitionTarget(start_transition);
+    LRAutomaton::Span reductions = automaton.Reductions(accept_state);
+    size_t k = find(reductions.begin(), reductions.end(), automaton.AugmentedRule()) - reductions.begin();
+    lookaheads.Set(automaton.ReductionIndex(accept_state) + k, 0);
+
+    if (relations)
+    {
+        relations->transitions = count;
+        relations->reads = reads.edges.size();
+        relations->includes = includes.size();
+        relations->lookback = lookback.size();
+    }
+    return lookaheads;
+}
@@ -0,0 +1,36 @@
+/*
+ * LALR(1) lookaheads of an LR(0) automaton.
+ *
+ * Computed with the relations of DeRemer and Pennello over the non
+ * terminal transitions (p, A) of the automaton:
+ *
+ *   DR(p, A)       terminals shifted right after goto(p, A)
+ *   reads          (p, A) reads (goto(p, A), C) if C is nullable
+ *   includes       (p, A) includes (p', B) if B -> beta A gamma, gamma is
+ *                  nullable and p' goes to p on beta
+ *   lookback       (q, A -> w) lookback (p, A) if p goes to q on w
+ *
+ * Read is DR closed under reads, Follow is Read closed under includes,
+ * and the lookaheads of a reduction are the union of Follow over its
+ * lookback transitions. Both closures use the SCC based digraph algorithm,
+ * so every relation edge is visited once and the sets are bitsets over the
+ * terminals.
+ */
+#ifndef __LALR__H__
+#define __LALR__H__
+
+#include "lr.h"
+
+struct LalrRelations
+// Sizes of the relations, for reporting
+{
+    long transitions = 0; // non terminal transitions
+    long reads = 0;
+    long includes = 0;
+    long lookback = 0;
+};
+
+// Rows are laid out like slrLookaheads
+Bitsets lalrLookaheads(const LRAutomaton &automaton, LalrRelations *relations = nullptr);
+
+#endif //__LALR__H__
@@ -0,0 +1,233 @@
+/*
+ * FIRST and FOLLOW sets computed on demand.
+ */
+#include <algorithm>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "lazysets.h"
+
+using namespace std;
+
+struct GrowingSet
+// A set in insertion order with a hashed membership test
+{
+    vector<string> elements;
+    unordered_set<string> members;
+
+    bool Add(const string &element)
+    {
+        if (!members.insert(element).second)
+            return false;
+        elements.push_back(element);
+        return true;
+    }
+};
+
+LazySets::LazySets(const CharacterType &c, const vector<Rule> &rules) : c(c)
+{
+    for (const string &terminal : c.terminals)
+    {
+        terminals[terminal] = true;
+        first_done[terminal] = {terminal};
+    }
+    for (const Rule &rule : rules)
+    {
+        rules_of[rule.lhs].push_back(&rule);
+        for (size_t i = 0; i < rule.rhs.size(); i++)
+            occurrences[rule.rhs[i]].push_back({&rule, i});
+    }
+}
+
+bool LazySets::IsNonTerminal(const string &symbol) const
+{
+    return rules_of.count(symbol) != 0;
+}
+
+bool LazySets::Nullable(const string &symbol)
+{
+    const vector<string> *set = First(symbol);
+    return set && find(set->begin(), set->end(), "#") != set->end();
+}
+
+const vector<string> *LazySets::First(const string &symbol)
+{
+    auto done = first_done.find(symbol);
+    if (done != first_done.end())
+        return &done->second;
+    if (!IsNonTerminal(symbol))
+        return nullptr;
+    SolveFirst(symbol);
+    return &first_done.at(symbol);
+}
+
+void LazySets::SolveFirst(const string &symbol)
+// Replays findFirstSets on the non terminals FIRST(symbol) can depend on:
+// those that start a rule of a member, through any non terminals before
+// them (which may turn out nullable). Task 2 sorts sets with "#" in the
+// order their elements were added, so the passes go over the rules of the
+// members in input order, exactly as findFirstSets does. A solved
+// non terminal is replayed again as a member, as its final set is not
+// what the earlier passes saw
+{
+    vector<string> members = {symbol};
+    unordered_set<string> in_closure = {symbol};
+    for (size_t m = 0; m < members.size(); m++)
+    {
+        for (const Rule *rule : rules_of[members[m]])
+        {
+            for (const string &each_rhs : rule->rhs)
+            {
+                if (!IsNonTerminal(each_rhs))
+                {
+                    if (each_rhs != "#")
+                        break;
+                    continue;
+                }
+                if (in_closure.insert(each_rhs).second)
+                    members.push_back(each_rhs);
+            }
+        }
+    }
+
+    // rules_of points into one vector, so address order is input order
+    vector<const Rule *> member_rules;
+    unordered_map<string, GrowingSet> work;
+    for (const string &member : members)
+    {
+        work[member];
+        member_rules.insert(member_rules.end(), rules_of[member].begin(), rules_of[member].end());
+    }
+    sort(member_rules.begin(), member_rules.end());
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Rule *rule : member_rules)
+        {
+            GrowingSet &set = work.at(rule->lhs);
+            size_t original_size = set.elements.size();
+            bool epsilon_in_all = false;
+            for (const string &each_rhs : rule->rhs)
+            {
+                // FIRST(lhs) on the RHS is read as it was before this rule
+                if (each_rhs == rule->lhs)
+                {
+                    epsilon_in_all = original_size != 0 && set.members.count("#") != 0;
+                    if (!epsilon_in_all)
+                        break;
+                    continue;
+                }
+                auto member = work.find(each_rhs);
+                const vector<string> &rhs_set = member != work.end() ? member->second.elements : first_done.at(each_rhs);
+                epsilon_in_all = false;
+                for (const string &element : rhs_set)
+                {
+                    if (element == "#")
+                        epsilon_in_all = true;
+                    else
+                        set.Add(element);
+                }
+                if (!epsilon_in_all)
+                    break;
+            }
+            // # goes on the extreme left
+            if (epsilon_in_all && set.members.insert("#").second)
+                set.elements.insert(set.elements.begin(), "#");
+            if (set.elements.size() != original_size)
+                changed = true;
+        }
+    }
+
+    // Sets already solved are the same, and may be referenced by callers
+    for (auto &entry : work)
+        first_done.emplace(entry.first, std::move(entry.second.elements));
+}
+
+const vector<string> *LazySets::Follow(const string &symbol)
+{
+    static const vector<string> empty_set;
+    auto done = follow_done.find(symbol);
+    if (done != follow_done.end())
+        return &done->second;
+    if (terminals.count(symbol))
+        return &empty_set;
+    if (!IsNonTerminal(symbol))
+        return nullptr;
+    SolveFollow(symbol);
+    return &follow_done.at(symbol);
+}
+
+void LazySets::SolveFollow(const string &symbol)
+// FOLLOW(X) is FIRST of what comes after X in the rules, plus FOLLOW of the
+// lhs when that is nullable; the lhs reached that way are solved together
+{
+    struct Inherit
+    {
+        size_t from; // member the elements come from
+        size_t to;
+        size_t copied; // elements of from already added to to
+    };
+
+    vector<string> members = {symbol};
+    unordered_map<string, size_t> member_index = {{symbol, 0}};
+    vector<GrowingSet> work(1);
+    vector<Inherit> inherits;
+    for (size_t m = 0; m < members.size(); m++)
+    {
+        const string member = members[m];
+        if (member == c.non_terminals[0])
+            work[m].Add("$");
+        for (const Occurrence &occurrence : occurrences[member])
+        {
+            const vector<string> &rhs = occurrence.rule->rhs;
+            bool suffix_nullable = true;
+            for (size_t i = occurrence.position + 1; i < rhs.size() && suffix_nullable; i++)
+            {
+                suffix_nullable = false;
+                for (const string &element : *First(rhs[i]))
+                {
+                    if (element == "#")
+                        suffix_nullable = true;
+                    else
+                        work[m].Add(element);
+                }
+            }
+            const string &lhs = occurrence.rule->lhs;
+            if (!suffix_nullable || lhs == member)
+                continue;
+            auto done = follow_done.find(lhs);
+            if (done != follow_done.end())
+            {
+                for (const string &element : done->second)
+                    work[m].Add(element);
+                continue;
+            }
+            auto found = member_index.emplace(lhs, members.size());
+            if (found.second)
+            {
+                members.push_back(lhs);
+                work.emplace_back();
+            }
+            inherits.push_back({found.first->second, m, 0});
+        }
+    }
+
+    // Sets only grow at the end, so each edge copies just what is new
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (Inherit &edge : inherits)
+        {
+            const vector<string> &from = work[edge.from].elements;
+            for (; edge.copied < from.size(); edge.copied++)
+                changed = work[edge.to].Add(from[edge.copied]) || changed;
+        }
+    }
+
+    for (size_t m = 0; m < members.size(); m++)
+        follow_done[members[m]] = std::move(work[m].elements);
+}
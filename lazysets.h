@@ -0,0 +1,59 @@
+/*
+ * FIRST and FOLLOW sets computed on demand.
+ *
+ * LazySets only solves the symbols a query depends on. For FIRST(X) that
+ * is X and every non terminal that can start one of its rules, through
+ * nullable prefixes; for FOLLOW(X) it is X and the left hand sides whose
+ * FOLLOW flows into it. The fixpoint runs over that closure only, which
+ * takes care of cycles, and every symbol of the closure is final when it
+ * is done, so it is remembered and a later query of it is answered at
+ * once.
+ *
+ * The sets are those of findFirstSets and findFollowSets. FIRST sets also
+ * get their elements in the same order ("#" first when present), because
+ * the order Task 2 prints a set with "#" in depends on it, so sortFirstSet
+ * and sortFollowSet print them exactly like Task 2 and Task 3.
+ */
+#ifndef __LAZYSETS__H__
+#define __LAZYSETS__H__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "project2.h"
+
+class LazySets
+{
+  public:
+    LazySets(const CharacterType &c, const std::vector<Rule> &rules);
+
+    // nullptr if the symbol is not in the grammar
+    const std::vector<std::string> *First(const std::string &symbol);
+    const std::vector<std::string> *Follow(const std::string &symbol);
+
+    // Non terminals solved so far, to see how much of the grammar a query touched
+    std::size_t FirstSolved() const { return first_done.size(); }
+    std::size_t FollowSolved() const { return follow_done.size(); }
+
+  private:
+    struct Occurrence
+    {
+        const Rule *rule;
+        std::size_t position;
+    };
+
+    bool IsNonTerminal(const std::string &symbol) const;
+    bool Nullable(const std::string &symbol);
+    void SolveFirst(const std::string &symbol);
+    void SolveFollow(const std::string &symbol);
+
+    const CharacterType &c;
+    std::unordered_map<std::string, std::vector<const Rule *>> rules_of;
+    std::unordered_map<std::string, std::vector<Occurrence>> occurrences;
+    std::unordered_map<std::string, bool> terminals;
+    Fsets first_done;
+    Fsets follow_done;
+};
+
+#endif //__LAZYSETS__H__
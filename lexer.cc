@@ -8,6 +8,13 @@
 #include <vector>
 #include <string>
 #include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <streambuf>
+#include <thread>
 
 #include "lexer.h"
 #include "inputbuf.h"
@@ -25,27 +32,91 @@ void Token::Print()
          << this->line_no << "}\n";
 }
 
+Token TokenHandle::ToToken() const
+{
+    Token token;
+    token.lexeme = string(Lexeme());
+    token.token_type = Type();
+    token.line_no = LineNo();
+    return token;
+}
+
+int TokenHandle::LineNo() const
+{
+    if (index == lexer->token_count)
+        return lexer->line_no;
+    const vector<uint32_t>& starts = lexer->line_starts;
+    return 1 + (upper_bound(starts.begin(), starts.end(), index) - starts.begin());
+}
+
 LexicalAnalyzer::LexicalAnalyzer()
+{
+    Tokenize();
+}
+
+// Same as the default constructor but reads the grammar from "stream"
+// instead of standard input
+LexicalAnalyzer::LexicalAnalyzer(istream& stream) : input(stream)
+{
+    Tokenize();
+}
+
+// Same as above, but reads all of "stream" first and lexes it in pieces
+LexicalAnalyzer::LexicalAnalyzer(istream& stream, int threads) : input(stream)
+{
+    if (threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    if (threads == 1) {
+        Tokenize();
+        return;
+    }
+    string text((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+    TokenizeChunks(text, threads);
+}
+
+void LexicalAnalyzer::Tokenize()
 {
     this->line_no = 1;
     tmp.lexeme = "";
     tmp.line_no = 1;
     tmp.token_type = ERROR;
 
+    token_count = 0;
     Token token = GetTokenMain();
     index = 0;
 
     while (token.token_type != END_OF_FILE)
     {
-        tokenList.push_back(token);     // push token into internal list
+        // push token into internal store
+        AddToken(token.token_type, token.lexeme.data(), token.lexeme.size(), token.line_no);
         token = GetTokenMain();        // and get next token from standatd input
     }
-    // pushes END_OF_FILE is not pushed on the token list
+    // END_OF_FILE is not pushed as a token, only as the entry past the end
+    EndTokens();
+}
+
+// Tokens come in order, so their lines never go down
+void LexicalAnalyzer::AddToken(TokenType type, const char* lexeme, size_t length, int line)
+{
+    while (1 + (int) line_starts.size() < line)
+        line_starts.push_back(token_count);
+    token_types.push_back(type);
+    lexeme_offsets.push_back(lexemes.size());
+    lexeme_lengths.push_back(length);
+    lexemes.append(lexeme, length);
+    token_count++;
+}
+
+void LexicalAnalyzer::EndTokens()
+{
+    token_types.push_back(END_OF_FILE);
+    lexeme_offsets.push_back(lexemes.size());
+    lexeme_lengths.push_back(0);
 }
 
 bool LexicalAnalyzer::SkipSpace()
 {
-    char c;
+    char c = 0; // left as is when reading past the end of the input
     bool space_encountered = false;
 
     input.GetChar(c);
@@ -65,7 +136,7 @@ bool LexicalAnalyzer::SkipSpace()
 
 Token LexicalAnalyzer::ScanId()
 {
-    char c;
+    char c = 0;
     input.GetChar(c);
 
     if (isalpha(c)) {
@@ -89,23 +160,26 @@ Token LexicalAnalyzer::ScanId()
     return tmp;
 }
 
-// GetToken() accesses tokens from the tokenList that is populated when a 
+// GetToken() accesses tokens from the token store that is populated when a 
 // lexer object is instantiated
 Token LexicalAnalyzer::GetToken()
 {
-    Token token;
-    if (index == tokenList.size()){       // return end of file if
-        token.lexeme = "";                // index is too large
-        token.line_no = line_no;
-        token.token_type = END_OF_FILE;
-    }
-    else{
-        token = tokenList[index];
+    return NextToken().ToToken();
+}
+
+TokenHandle LexicalAnalyzer::NextToken()
+{
+    TokenHandle token(this, index);    // END_OF_FILE if index is too large
+    if (index < token_count)
         index = index + 1;
-    }
     return token;
 }
 
+int LexicalAnalyzer::TokenCount()
+{
+    return token_count;
+}
+
 // peek requires that the argument "howFar" be positive.
 Token LexicalAnalyzer::peek(int howFar)
 {
@@ -114,20 +188,12 @@ Token LexicalAnalyzer::peek(int howFar)
         exit(-1);
     }
 
-    int peekIndex = index + howFar - 1;
-    if (peekIndex > ((int)tokenList.size()-1)) { // if peeking too far
-        Token token;                        // return END_OF_FILE
-        token.lexeme = "";
-        token.line_no = line_no;
-        token.token_type = END_OF_FILE;
-        return token;
-    } else
-        return tokenList[peekIndex];
+    return PeekToken(howFar).ToToken();     // END_OF_FILE if peeking too far
 }
 
 Token LexicalAnalyzer::GetTokenMain()
 {
-    char c;
+    char c = 0;
     
     SkipSpace();
     tmp.lexeme = "";
@@ -169,3 +235,91 @@ Token LexicalAnalyzer::GetTokenMain()
     }
 }
 
+
+// Inputs smaller than this are lexed on one thread
+static const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// Reads part of a string in place
+class MemoryBuffer : public streambuf {
+  public:
+    MemoryBuffer(const char* first, const char* last)
+    {
+        setg(const_cast<char*>(first), const_cast<char*>(first), const_cast<char*>(last));
+    }
+};
+
+// Every '*' of the input is read as a STAR token, after which nothing is
+// pushed back into the input buffer. A new lexer started right after a '*'
+// therefore produces the same tokens as the one that read up to it, only
+// with line numbers counted from 1 instead of from the newlines before it.
+void LexicalAnalyzer::TokenizeChunks(const string& text, int threads)
+{
+    size_t count = min<size_t>(threads, max<size_t>(1, text.size() / MIN_CHUNK_BYTES));
+
+    // Chunk k is [end[k-1], end[k]), cut after the first '*' past an even
+    // share of the input
+    vector<size_t> end;
+    size_t begin = 0;
+    for (size_t k = 1; k < count; k++) {
+        size_t target = max(begin, text.size() * k / count);
+        const char* star = (const char*) memchr(text.data() + target, '*', text.size() - target);
+        if (star == NULL || star + 1 == text.data() + text.size())
+            break;
+        begin = star + 1 - text.data();
+        end.push_back(begin);
+    }
+    end.push_back(text.size());
+
+    size_t chunks = end.size();
+    vector<unique_ptr<LexicalAnalyzer> > parts(chunks);
+    vector<int> newlines(chunks);
+    atomic<size_t> next(0);
+    auto work = [&]()
+    {
+        for (size_t k = next++; k < chunks; k = next++) {
+            const char* first = text.data() + (k ? end[k - 1] : 0);
+            const char* last = text.data() + end[k];
+            MemoryBuffer buffer(first, last);
+            istream in(&buffer);
+            parts[k].reset(new LexicalAnalyzer(in));
+            // A chunk other than the last ends with its STAR token, which is
+            // on the line after the last newline the lexer counted (not every
+            // '\n' counts, one read as an ERROR token does not)
+            LexicalAnalyzer& part = *parts[k];
+            if (part.token_count)
+                newlines[k] = TokenHandle(&part, part.token_count - 1).LineNo() - 1;
+        }
+    };
+    vector<thread> workers;
+    for (size_t t = 1; t < min<size_t>(threads, chunks); t++)
+        workers.emplace_back(work);
+    work();
+    for (thread& worker : workers)
+        worker.join();
+
+    // Prefix sum of the newline counts gives the line each chunk starts on
+    size_t total = 0, total_lexemes = 0;
+    for (size_t k = 0; k < chunks; k++) {
+        total += parts[k]->token_count;
+        total_lexemes += parts[k]->lexemes.size();
+    }
+    token_types.reserve(total + 1);
+    lexeme_offsets.reserve(total + 1);
+    lexeme_lengths.reserve(total + 1);
+    lexemes.reserve(total_lexemes);
+    token_count = 0;
+    int lines_before = 0;
+    for (size_t k = 0; k < chunks; k++) {
+        const LexicalAnalyzer& part = *parts[k];
+        for (uint32_t i = 0; i < part.token_count; i++) {
+            TokenHandle token(&part, i);
+            string_view lexeme = token.Lexeme();
+            AddToken(token.Type(), lexeme.data(), lexeme.size(), token.LineNo() + lines_before);
+        }
+        this->line_no = part.line_no + lines_before;
+        lines_before += newlines[k];
+        parts[k].reset();
+    }
+    EndTokens();
+    index = 0;
+}
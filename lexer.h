@@ -6,8 +6,11 @@
 #ifndef __LEXER__H__
 #define __LEXER__H__
 
+#include <cstdint>
+#include <istream>
 #include <vector>
 #include <string>
+#include <string_view>
 
 #include "inputbuf.h"
 
@@ -24,22 +27,96 @@ class Token {
     int line_no;
 };
 
+class LexicalAnalyzer;
+
+// A token in the store of a LexicalAnalyzer, valid as long as the lexer is.
+// It is a pointer and an index, so it is copied for free; the lexeme is
+// read in place and the line number is only looked up when asked for.
+class TokenHandle {
+  public:
+    TokenType Type() const;
+    std::string_view Lexeme() const;
+    int LineNo() const;
+    Token ToToken() const;
+
+  private:
+    friend class LexicalAnalyzer;
+    TokenHandle(const LexicalAnalyzer* lexer, uint32_t index) : lexer(lexer), index(index) {}
+
+    const LexicalAnalyzer* lexer;
+    uint32_t index;
+};
+
 class LexicalAnalyzer {
   public:
     Token GetToken();
     Token peek(int);
+    // Same as GetToken() and peek(), without copying the token
+    TokenHandle NextToken();
+    TokenHandle PeekToken(int howFar) const;
+    // Type of peek(howFar), a single load
+    TokenType PeekType(int howFar) const;
+    int TokenCount();
     LexicalAnalyzer();
+    explicit LexicalAnalyzer(std::istream&);
+    // Same tokens, but a large input is cut after "*" characters and the
+    // pieces are lexed on up to "threads" threads (<= 0 for every core)
+    LexicalAnalyzer(std::istream&, int threads);
 
   private:
-    std::vector<Token> tokenList;
+    friend class TokenHandle;
+
+    // The tokens as parallel arrays, followed by one END_OF_FILE entry
+    // that stands for every token past the end
+    std::vector<uint8_t> token_types;
+    std::vector<uint32_t> lexeme_offsets; // into lexemes
+    std::vector<uint32_t> lexeme_lengths;
+    std::string lexemes; // text of the ID tokens, one after the other
+    // Index of the first token after each newline: a token is on line 1 +
+    // the number of entries at or below its index
+    std::vector<uint32_t> line_starts;
+    uint32_t token_count;
+
+    void AddToken(TokenType type, const char* lexeme, size_t length, int line);
+    void EndTokens();
+    uint32_t PeekIndex(int howFar) const;
+
     Token GetTokenMain();
     int line_no;
-    int index;
+    uint32_t index;
     Token tmp;
     InputBuffer input;
 
+    void Tokenize();
+    void TokenizeChunks(const std::string& text, int threads);
     bool SkipSpace();
     Token ScanId();
 };
 
+inline uint32_t LexicalAnalyzer::PeekIndex(int howFar) const
+{
+    uint32_t peekIndex = index + howFar - 1;
+    return peekIndex < token_count ? peekIndex : token_count;
+}
+
+inline TokenType LexicalAnalyzer::PeekType(int howFar) const
+{
+    return (TokenType) token_types[PeekIndex(howFar)];
+}
+
+inline TokenHandle LexicalAnalyzer::PeekToken(int howFar) const
+{
+    return TokenHandle(this, PeekIndex(howFar));
+}
+
+inline TokenType TokenHandle::Type() const
+{
+    return (TokenType) lexer->token_types[index];
+}
+
+inline std::string_view TokenHandle::Lexeme() const
+{
+    return std::string_view(lexer->lexemes.data() + lexer->lexeme_offsets[index], lexer->lexeme_lengths[index]);
+}
+
 #endif  //__LEXER__H__
@@ -0,0 +1,289 @@
+/*
+ * FIRST_k and FOLLOW_k sets, and the smallest k for which each non
+ * terminal can be parsed with k tokens of lookahead.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "llk.h"
+
+using namespace std;
+
+static const int LANE_BITS = 16;
+static const uint64_t LANE_MASK = 0xffff;
+
+static int stringLength(uint64_t string)
+{
+    if (string == 0)
+        return 0;
+    return (64 - __builtin_clzll(string) + LANE_BITS - 1) / LANE_BITS;
+}
+
+LLkSets::LLkSets(const CharacterType &c, const vector<Rule> &rules)
+    : non_terminal_count(c.non_terminals.size()), end_marker(0), supported(true), k(0)
+{
+    unordered_map<string, int> ids;
+    for (size_t n = 0; n < c.non_terminals.size(); n++)
+        ids.emplace(c.non_terminals[n], n);
+    for (const string &terminal : c.terminals)
+    {
+        if (terminal == "#")
+            continue;
+        terminal_names.push_back(terminal);
+        ids.emplace(terminal, non_terminal_count + terminal_names.size() - 1);
+    }
+    end_marker = terminal_names.size() + 1;
+    if (end_marker > LANE_MASK)
+    {
+        supported = false;
+        return;
+    }
+
+    productions_of.resize(non_terminal_count);
+    for (const Rule &rule : rules)
+    {
+        Production production;
+        production.lhs = ids.at(rule.lhs);
+        for (const string &symbol : rule.rhs)
+        {
+            if (symbol != "#")
+                production.rhs.push_back(ids.at(symbol));
+        }
+        productions_of[production.lhs].push_back(productions.size());
+        productions.push_back(std::move(production));
+    }
+}
+
+bool LLkSets::IsComplete(uint64_t string) const
+{
+    int length = stringLength(string);
+    return length == k || (length > 0 && (string >> (length - 1) * LANE_BITS & LANE_MASK) == end_marker);
+}
+
+uint64_t LLkSets::Concatenate(uint64_t prefix, uint64_t suffix) const
+{
+    if (IsComplete(prefix))
+        return prefix;
+    uint64_t joined = prefix | suffix << stringLength(prefix) * LANE_BITS;
+    if (k < LLK_MAX_K)
+        joined &= (uint64_t(1) << k * LANE_BITS) - 1;
+    return joined;
+}
+
+static void sortUnique(vector<uint64_t> &strings)
+{
+    sort(strings.begin(), strings.end());
+    strings.erase(unique(strings.begin(), strings.end()), strings.end());
+}
+
+static void markTooLarge(LLkSet &set)
+{
+    set.too_large = true;
+    vector<uint64_t>().swap(set.strings);
+}
+
+void LLkSets::Concatenate(const LLkSet &prefixes, const LLkSet &suffixes, LLkSet &result) const
+// Every prefix followed by every suffix, cut to k. Duplicates are removed
+// whenever the result doubles past the limit, so it never holds much more
+{
+    result.strings.clear();
+    result.too_large = prefixes.too_large;
+    if (result.too_large)
+        return;
+    for (uint64_t prefix : prefixes.strings)
+    {
+        if (IsComplete(prefix))
+        {
+            result.strings.push_back(prefix);
+            continue;
+        }
+        if (suffixes.too_large)
+        {
+            markTooLarge(result);
+            return;
+        }
+        for (uint64_t suffix : suffixes.strings)
+        {
+            result.strings.push_back(Concatenate(prefix, suffix));
+            if (result.strings.size() > 2 * LLK_MAX_SET_SIZE)
+            {
+                sortUnique(result.strings);
+                if (result.strings.size() > LLK_MAX_SET_SIZE)
+                {
+                    markTooLarge(result);
+                    return;
+                }
+            }
+        }
+    }
+    sortUnique(result.strings);
+    if (result.strings.size() > LLK_MAX_SET_SIZE)
+        markTooLarge(result);
+}
+
+bool LLkSets::Add(LLkSet &set, const LLkSet &from) const
+{
+    if (set.too_large)
+        return false;
+    if (from.too_large)
+    {
+        markTooLarge(set);
+        return true;
+    }
+    if (includes(set.strings.begin(), set.strings.end(), from.strings.begin(), from.strings.end()))
+        return false;
+    vector<uint64_t> merged;
+    merged.reserve(set.strings.size() + from.strings.size());
+    set_union(set.strings.begin(), set.strings.end(), from.strings.begin(), from.strings.end(), back_inserter(merged));
+    if (merged.size() > LLK_MAX_SET_SIZE)
+        markTooLarge(set);
+    else
+        set.strings.swap(merged);
+    return true;
+}
+
+const LLkSet &LLkSets::SymbolFirst(int symbol, LLkSet &terminal) const
+{
+    if (symbol < (int)non_terminal_count)
+        return first[symbol];
+    terminal.too_large = false;
+    terminal.strings.assign(1, symbol - non_terminal_count + 1);
+    return terminal;
+}
+
+void LLkSets::RuleFirst(const vector<int> &rhs, size_t from, LLkSet &result) const
+// FIRST_k(rhs[from..]), left to right until every string is complete
+{
+    result.too_large = false;
+    result.strings.assign(1, 0);
+    LLkSet terminal, joined;
+    for (size_t i = from; i < rhs.size(); i++)
+    {
+        if (all_of(result.strings.begin(), result.strings.end(), [this](uint64_t string)
+                   { return IsComplete(string); }))
+            break;
+        Concatenate(result, SymbolFirst(rhs[i], terminal), joined);
+        swap(result, joined);
+        if (result.too_large)
+            return;
+    }
+}
+
+void LLkSets::Compute(int lookahead)
+{
+    k = lookahead;
+    first.assign(non_terminal_count, LLkSet());
+    follow.assign(non_terminal_count, LLkSet());
+    if (!supported || non_terminal_count == 0)
+        return;
+
+    // Both fixpoints only ever add strings, and a set that is too large
+    // stays so
+    LLkSet set, trailer;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Production &production : productions)
+        {
+            RuleFirst(production.rhs, 0, set);
+            changed |= Add(first[production.lhs], set);
+        }
+    }
+
+    follow[0].strings.assign(1, end_marker);
+    changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Production &production : productions)
+        {
+            // FIRST_k of what comes after rhs[i], followed by FOLLOW_k of
+            // the left hand side. Concatenation is not associative when a
+            // set is empty (complete strings get through it, the others do
+            // not), so the trailer is built left to right like the
+            // lookaheads ConflictFree compares, and not from the back
+            for (size_t i = 0; i < production.rhs.size(); i++)
+            {
+                int symbol = production.rhs[i];
+                if (symbol >= (int)non_terminal_count)
+                    continue;
+                RuleFirst(production.rhs, i + 1, trailer);
+                Concatenate(trailer, follow[production.lhs], set);
+                changed |= Add(follow[symbol], set);
+            }
+        }
+    }
+}
+
+int LLkSets::ConflictFree(size_t non_terminal) const
+{
+    vector<uint64_t> lookaheads;
+    bool too_large = false;
+    LLkSet rule_first, rule_lookaheads;
+    for (int p : productions_of[non_terminal])
+    {
+        RuleFirst(productions[p].rhs, 0, rule_first);
+        Concatenate(rule_first, follow[non_terminal], rule_lookaheads);
+        too_large |= rule_lookaheads.too_large;
+        lookaheads.insert(lookaheads.end(), rule_lookaheads.strings.begin(), rule_lookaheads.strings.end());
+    }
+    // The sets of one rule have no duplicates, so a duplicate is a string
+    // two rules share
+    sort(lookaheads.begin(), lookaheads.end());
+    if (adjacent_find(lookaheads.begin(), lookaheads.end()) != lookaheads.end())
+        return 0;
+    return too_large ? -1 : 1;
+}
+
+string LLkSets::Name(uint64_t string) const
+{
+    std::string name;
+    for (; string; string >>= LANE_BITS)
+    {
+        uint64_t terminal = string & LANE_MASK;
+        if (!name.empty())
+            name += ' ';
+        name += terminal == end_marker ? "$" : terminal_names[terminal - 1];
+    }
+    return name;
+}
+
+vector<LLkResult> findLLk(const CharacterType &c, const vector<Rule> &rules, int max_k)
+{
+    LLkSets sets(c, rules);
+    if (!sets.Supported())
+        return {};
+    vector<LLkResult> results(c.non_terminals.size());
+    vector<size_t> open;
+    for (size_t n = 0; n < c.non_terminals.size(); n++)
+        open.push_back(n);
+    // Conflict free at k means conflict free at every larger k, so each
+    // non terminal is only checked until its k is found
+    for (int k = 1; k <= max_k && !open.empty(); k++)
+    {
+        sets.Compute(k);
+        vector<size_t> still_open;
+        for (size_t n : open)
+        {
+            int conflict_free = sets.ConflictFree(n);
+            if (conflict_free == 1)
+                results[n].k = k;
+            else
+            {
+                // A conflict at k is one at every smaller k as well
+                if (conflict_free == 0)
+                    results[n].undecided_at = 0;
+                else if (results[n].undecided_at == 0)
+                    results[n].undecided_at = k;
+                still_open.push_back(n);
+            }
+        }
+        open.swap(still_open);
+    }
+    return results;
+}
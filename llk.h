@@ -0,0 +1,117 @@
+/*
+ * FIRST_k and FOLLOW_k sets, and the smallest k for which each non
+ * terminal can be parsed with k tokens of lookahead.
+ *
+ * A string of up to k terminals is one 64 bit id: 16 bits per terminal
+ * number (1 up to 65534, then "$"), the first terminal in the low bits and
+ * 0 past the end, so equal strings have equal ids and the empty string is
+ * 0. A set is a sorted vector of ids. Concatenation keeps the first k
+ * terminals: a string of k terminals, or one that ends with "$", is not
+ * extended.
+ *
+ * The sets generalize findFirstSets and findFollowSets: FIRST_k(A) holds
+ * the first k terminals of the strings A derives (shorter ones if the
+ * string is shorter, the empty string if A is nullable), and FOLLOW_k(A)
+ * those of what can follow A, with "$" after the first non terminal. A non
+ * terminal A is conflict free at k (strong LL(k)) when the sets
+ * FIRST_k(alpha) . FOLLOW_k(A) of its rules A -> alpha do not intersect;
+ * for k = 1 that is the usual LL(1) condition.
+ *
+ * k goes from 1 up to the largest k asked for, and stops as soon as every
+ * non terminal is conflict free. A set that would grow past
+ * LLK_MAX_SET_SIZE strings is not kept: it is marked as too large, and so
+ * is everything computed from it, and the non terminals whose decision
+ * needs it are reported as undecided at that k. Memory stays at most that
+ * many ids per set, whatever k and the size of the grammar.
+ */
+#ifndef __LLK__H__
+#define __LLK__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "project2.h"
+
+// Largest k, so that a string fits in 64 bits
+#define LLK_MAX_K 4
+
+// Largest set of strings kept, can be changed with -D
+#ifndef LLK_MAX_SET_SIZE
+#define LLK_MAX_SET_SIZE 4096
+#endif
+
+struct LLkSet
+{
+    std::vector<uint64_t> strings; // sorted
+    bool too_large = false;
+};
+
+struct LLkResult
+// For one non terminal
+{
+    // Smallest k at which it is conflict free, 0 if there is none up to
+    // the largest k tried
+    int k = 0;
+    // The k at which its sets got too large, 0 if they never did
+    int undecided_at = 0;
+};
+
+class LLkSets
+{
+  public:
+    LLkSets(const CharacterType &c, const std::vector<Rule> &rules);
+
+    // False if the grammar has too many terminals for 16 bit numbers
+    bool Supported() const { return supported; }
+
+    // Computes the sets for this k (1 to LLK_MAX_K)
+    void Compute(int k);
+    // For the k of the last Compute(), by non terminal number (the order
+    // of c.non_terminals)
+    const LLkSet &First(std::size_t non_terminal) const { return first[non_terminal]; }
+    const LLkSet &Follow(std::size_t non_terminal) const { return follow[non_terminal]; }
+    // 1 if the rules of the non terminal have disjoint lookahead sets at
+    // the last k, 0 if two of them share a string, -1 if a set was too large
+    int ConflictFree(std::size_t non_terminal) const;
+
+    // Terminals of a string, "$" included, separated by spaces
+    std::string Name(uint64_t string) const;
+
+  private:
+    bool IsComplete(uint64_t string) const;
+    uint64_t Concatenate(uint64_t prefix, uint64_t suffix) const;
+    void Concatenate(const LLkSet &prefixes, const LLkSet &suffixes, LLkSet &result) const;
+    // Adds the strings of from, returns true if set changed
+    bool Add(LLkSet &set, const LLkSet &from) const;
+    // first[symbol], or {symbol} in terminal for a terminal
+    const LLkSet &SymbolFirst(int symbol, LLkSet &terminal) const;
+    // FIRST_k(rhs[from..])
+    void RuleFirst(const std::vector<int> &rhs, std::size_t from, LLkSet &result) const;
+
+    // Symbols: 0 .. non_terminal_count - 1 are the non terminals, then
+    // terminal t is non_terminal_count + t - 1 (t from 1); "#" is left out
+    // of right hand sides
+    std::size_t non_terminal_count;
+    std::vector<std::string> terminal_names; // [t - 1]
+    uint64_t end_marker;                     // "$"
+    struct Production
+    {
+        int lhs;
+        std::vector<int> rhs;
+    };
+    std::vector<Production> productions;
+    std::vector<std::vector<int>> productions_of;
+    bool supported;
+
+    int k;
+    std::vector<LLkSet> first;
+    std::vector<LLkSet> follow;
+};
+
+// Smallest k up to max_k for every non terminal, in the order of
+// c.non_terminals; empty if the grammar has too many terminals
+std::vector<LLkResult> findLLk(const CharacterType &c, const std::vector<Rule> &rules, int max_k);
+
+#endif //__LLK__H__
@@ -0,0 +1,371 @@
+/*
+ * LR(0) automaton and SLR(1) lookaheads.
+ */
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "lr.h"
+
+using namespace std;
+
+LRAutomaton::LRAutomaton(const CharacterType &c, const vector<Rule> &rules) : terminal_count(0), closure_items(0)
+{
+    kernel_start.push_back(0);
+    transition_start.push_back(0);
+    reduction_start.push_back(0);
+    InternGrammar(c, rules);
+    if (rules.empty())
+        return;
+    BuildClosureCache();
+    BuildStates();
+}
+
+void LRAutomaton::InternGrammar(const CharacterType &c, const vector<Rule> &rules)
+{
+    auto add = [this](const string &name)
+    {
+        ids.emplace(name, (int)names.size());
+        names.push_back(name);
+    };
+    add("$");
+    for (const string &terminal : c.terminals)
+    {
+        if (terminal != "#")
+            add(terminal);
+    }
+    terminal_count = names.size();
+    for (const string &non_terminal : c.non_terminals)
+        add(non_terminal);
+    if (rules.empty())
+        return;
+    add(c.non_terminals[0] + "'"); // IDs cannot contain ', so this is a new name
+
+    rules_of.resize(names.size() - terminal_count);
+    auto addRule = [this](int lhs, const vector<int> &symbols)
+    {
+        rules_of[lhs - terminal_count].push_back(rule_lhs.size());
+        rule_lhs.push_back(lhs);
+        rule_start.push_back(rhs.size());
+        rhs.insert(rhs.end(), symbols.begin(), symbols.end());
+    };
+    vector<int> symbols;
+    for (const Rule &rule : rules)
+    {
+        symbols.clear();
+        for (const string &symbol : rule.rhs)
+        {
+            if (symbol != "#")
+                symbols.push_back(ids.at(symbol));
+        }
+        addRule(ids.at(rule.lhs), symbols);
+    }
+    addRule(names.size() - 1, {ids.at(c.non_terminals[0])});
+    rule_start.push_back(rhs.size());
+
+    for (int r = 0; r < RuleCount(); r++)
+    {
+        item_base.push_back(item_rule.size());
+        for (int dot = 0; dot <= rule_start[r + 1] - rule_start[r]; dot++)
+        {
+            item_rule.push_back(r);
+            next_symbol.push_back(rule_start[r] + dot < rule_start[r + 1] ? rhs[rule_start[r] + dot] : -1);
+        }
+    }
+
+    // Nullable non terminals: a rule makes its lhs nullable once all of its
+    // rhs symbols are nullable
+    nullable.assign(names.size(), false);
+    vector<int> pending(RuleCount());
+    vector<vector<int>> occurrences(names.size());
+    vector<int> worklist;
+    for (int r = 0; r < RuleCount(); r++)
+    {
+        bool has_terminal = false;
+        for (int symbol : RuleRhs(r))
+        {
+            if (IsTerminal(symbol))
+                has_terminal = true;
+            else
+            {
+                pending[r]++;
+                occurrences[symbol].push_back(r);
+            }
+        }
+        if (has_terminal)
+            pending[r] = -1; // never nullable
+        else if (pending[r] == 0 && !nullable[rule_lhs[r]])
+        {
+            nullable[rule_lhs[r]] = true;
+            worklist.push_back(rule_lhs[r]);
+        }
+    }
+    while (!worklist.empty())
+    {
+        int symbol = worklist.back();
+        worklist.pop_back();
+        for (int r : occurrences[symbol])
+        {
+            if (pending[r] > 0 && --pending[r] == 0 && !nullable[rule_lhs[r]])
+            {
+                nullable[rule_lhs[r]] = true;
+                worklist.push_back(rule_lhs[r]);
+            }
+        }
+    }
+}
+
+void LRAutomaton::BuildClosureCache()
+// For every non terminal, the non terminals whose dot 0 items its closure
+// contains (itself included), found through the leading symbol of rules
+{
+    int non_terminal_count = names.size() - terminal_count;
+    closure_cache.resize(non_terminal_count);
+    vector<int> visited(non_terminal_count, -1);
+    for (int a = 0; a < non_terminal_count; a++)
+    {
+        vector<int> &closure = closure_cache[a];
+        closure.push_back(a);
+        visited[a] = a;
+        for (size_t i = 0; i < closure.size(); i++)
+        {
+            for (int r : rules_of[closure[i]])
+            {
+                int first = next_symbol[item_base[r]];
+                if (first >= 0 && !IsTerminal(first) && visited[first - terminal_count] != a)
+                {
+                    visited[first - terminal_count] = a;
+                    closure.push_back(first - terminal_count);
+                }
+            }
+        }
+    }
+}
+
+struct KernelHash
+{
+    size_t operator()(const vector<int> &kernel) const
+    {
+        uint64_t hash = 1469598103934665603ull;
+        for (int item : kernel)
+            hash = (hash ^ (uint32_t)item) * 1099511628211ull;
+        return hash;
+    }
+};
+
+void LRAutomaton::BuildStates()
+{
+    unordered_map<vector<int>, int, KernelHash> states;
+    vector<int> kernel = {item_base[AugmentedRule()]};
+    states.emplace(kernel, 0);
+    kernels = kernel;
+    kernel_start.push_back(kernels.size());
+
+    vector<int> added(names.size() - terminal_count, -1);
+    vector<vector<int>> buckets(names.size());
+    vector<int> symbols;
+    vector<int> items;
+    for (int s = 0; s < StateCount(); s++)
+    {
+        items.assign(kernels.begin() + kernel_start[s], kernels.begin() + kernel_start[s + 1]);
+        size_t kernel_size = items.size();
+        for (size_t i = 0; i < kernel_size; i++)
+        {
+            int symbol = next_symbol[items[i]];
+            if (symbol < 0 || IsTerminal(symbol))
+                continue;
+            for (int b : closure_cache[symbol - terminal_count])
+            {
+                if (added[b] == s)
+                    continue;
+                added[b] = s;
+                for (int r : rules_of[b])
+                    items.push_back(item_base[r]);
+            }
+        }
+        closure_items += items.size();
+
+        for (int item : items)
+        {
+            int symbol = next_symbol[item];
+            if (symbol < 0)
+            {
+                reductions.push_back(item_rule[item]);
+                continue;
+            }
+            if (buckets[symbol].empty())
+                symbols.push_back(symbol);
+            buckets[symbol].push_back(item + 1);
+        }
+        reduction_start.push_back(reductions.size());
+
+        sort(symbols.begin(), symbols.end());
+        for (int symbol : symbols)
+        {
+            vector<int> &next = buckets[symbol];
+            sort(next.begin(), next.end());
+            auto inserted = states.emplace(next, StateCount());
+            if (inserted.second)
+            {
+                kernels.insert(kernels.end(), next.begin(), next.end());
+                kernel_start.push_back(kernels.size());
+            }
+            transitions.push_back(symbol);
+            transitions.push_back(inserted.first->second);
+            next.clear();
+        }
+        transition_start.push_back(transitions.size());
+        symbols.clear();
+    }
+}
+
+int LRAutomaton::SymbolId(const string &name) const
+{
+    auto it = ids.find(name);
+    return it == ids.end() ? -1 : it->second;
+}
+
+LRAutomaton::Span LRAutomaton::RuleRhs(int rule) const
+{
+    return {rhs.data() + rule_start[rule], rhs.data() + rule_start[rule + 1]};
+}
+
+string LRAutomaton::RuleText(int rule) const
+{
+    string text = names[rule_lhs[rule]] + " ->";
+    for (int symbol : RuleRhs(rule))
+        text += " " + names[symbol];
+    if (RuleRhs(rule).size() == 0)
+        text += " #";
+    return text;
+}
+
+LRAutomaton::Span LRAutomaton::RulesOf(int non_terminal) const
+{
+    const vector<int> &list = rules_of[non_terminal - terminal_count];
+    return {list.data(), list.data() + list.size()};
+}
+
+LRAutomaton::Span LRAutomaton::Kernel(int state) const
+{
+    return {kernels.data() + kernel_start[state], kernels.data() + kernel_start[state + 1]};
+}
+
+LRAutomaton::Span LRAutomaton::Transitions(int state) const
+{
+    return {transitions.data() + transition_start[state], transitions.data() + transition_start[state + 1]};
+}
+
+int LRAutomaton::TransitionIndex(int state, int symbol) const
+{
+    int low = transition_start[state] / 2, high = transition_start[state + 1] / 2;
+    while (low < high)
+    {
+        int middle = (low + high) / 2;
+        if (transitions[2 * middle] < symbol)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low < transition_start[state + 1] / 2 && transitions[2 * low] == symbol)
+        return low;
+    return -1;
+}
+
+int LRAutomaton::Goto(int state, int symbol) const
+{
+    int index = TransitionIndex(state, symbol);
+    return index < 0 ? -1 : transitions[2 * index + 1];
+}
+
+LRAutomaton::Span LRAutomaton::Reductions(int state) const
+{
+    return {reductions.data() + reduction_start[state], reductions.data() + reduction_start[state + 1]};
+}
+
+Bitsets slrLookaheads(const LRAutomaton &automaton, const Fsets &follow_sets)
+{
+    Bitsets lookaheads(automaton.ReductionCount(), automaton.TerminalCount());
+    for (int s = 0; s < automaton.StateCount(); s++)
+    {
+        LRAutomaton::Span reductions = automaton.Reductions(s);
+        for (size_t k = 0; k < reductions.size(); k++)
+        {
+            int row = automaton.ReductionIndex(s) + k;
+            if (reductions[k] == automaton.AugmentedRule())
+            {
+                lookaheads.Set(row, 0);
+                continue;
+            }
+            auto follow = follow_sets.find(automaton.SymbolName(automaton.RuleLhs(reductions[k])));
+            if (follow == follow_sets.end())
+                continue;
+            for (const string &terminal : follow->second)
+            {
+                int id = automaton.SymbolId(terminal);
+                if (id >= 0 && automaton.IsTerminal(id))
+                    lookaheads.Set(row, id);
+            }
+        }
+    }
+    return lookaheads;
+}
+
+vector<LRConflict> findConflicts(const LRAutomaton &automaton, const Bitsets &lookaheads)
+{
+    vector<LRConflict> conflicts;
+    for (int s = 0; s < automaton.StateCount(); s++)
+    {
+        LRAutomaton::Span reductions = automaton.Reductions(s);
+        if (reductions.size() == 0)
+            continue;
+        int row = automaton.ReductionIndex(s);
+        for (int t = 0; t < automaton.TerminalCount(); t++)
+        {
+            LRConflict conflict = {s, t, automaton.Goto(s, t), -1, -1, 0};
+            for (size_t i = 0; i < reductions.size(); i++)
+            {
+                if (!lookaheads.Test(row + i, t))
+                    continue;
+                if (conflict.reduces == 0)
+                    conflict.first = reductions[i];
+                else if (conflict.reduces == 1)
+                    conflict.second = reductions[i];
+                conflict.reduces++;
+            }
+            if (conflict.reduces + (conflict.shift >= 0) > 1)
+                conflicts.push_back(conflict);
+        }
+    }
+    return conflicts;
+}
+
+void printConflicts(ostream &out, const char *name, const LRAutomaton &automaton, const vector<LRConflict> &conflicts, size_t limit)
+{
+    size_t shift_reduce = 0;
+    for (const LRConflict &conflict : conflicts)
+    {
+        if (conflict.shift >= 0)
+            shift_reduce++;
+    }
+    out << name << " conflicts: " << conflicts.size() << " (" << shift_reduce << " shift/reduce, "
+        << conflicts.size() - shift_reduce << " reduce/reduce)\n";
+
+    for (size_t i = 0; i < conflicts.size() && i < limit; i++)
+    {
+        const LRConflict &conflict = conflicts[i];
+        out << "  state " << conflict.state << " on " << automaton.SymbolName(conflict.terminal) << ": ";
+        if (conflict.shift >= 0)
+            out << "shift " << conflict.shift;
+        else
+            out << "reduce " << automaton.RuleText(conflict.second);
+        out << " / reduce " << automaton.RuleText(conflict.first);
+        if (conflict.reduces + (conflict.shift >= 0) > 2)
+            out << " (" << conflict.reduces + (conflict.shift >= 0) << " actions)";
+        out << "\n";
+    }
+    if (conflicts.size() > limit)
+        out << "  ... " << conflicts.size() - limit << " more\n";
+}
@@ -0,0 +1,132 @@
+/*
+ * LR(0) automaton and SLR(1) lookaheads.
+ *
+ * Symbols and rules are interned to integers. The grammar is augmented
+ * with S' -> S, where S is the first non terminal. An item (rule, dot) is
+ * packed into one integer, ItemBase(rule) + dot, so item sets are plain
+ * int arrays. The closure of every non terminal (all dot 0 items reachable
+ * through leading non terminals) is computed once and merged into each
+ * state, and kernels are canonicalized by sorting and hashing, so each
+ * state is closed and looked up exactly once.
+ *
+ * Lookaheads are bitsets over the terminals, one row per reduction (a
+ * completed item of a state). slrLookaheads fills them from the FOLLOW
+ * sets; findConflicts reports every terminal on which a state has more
+ * than one action, once per state and terminal.
+ */
+#ifndef __LR__H__
+#define __LR__H__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bitsets.h"
+#include "project2.h"
+
+class LRAutomaton
+{
+  public:
+    struct Span
+    {
+        const int *first;
+        const int *last;
+
+        const int *begin() const { return first; }
+        const int *end() const { return last; }
+        std::size_t size() const { return last - first; }
+        int operator[](std::size_t i) const { return first[i]; }
+    };
+
+    LRAutomaton(const CharacterType &c, const std::vector<Rule> &rules);
+
+    // Symbols: 0 is "$", then the terminals, then the non terminals and S'
+    int SymbolCount() const { return names.size(); }
+    int TerminalCount() const { return terminal_count; } // including "$"
+    bool IsTerminal(int symbol) const { return symbol < terminal_count; }
+    const std::string &SymbolName(int symbol) const { return names[symbol]; }
+    int SymbolId(const std::string &name) const; // -1 if unknown
+    bool Nullable(int symbol) const { return nullable[symbol]; }
+
+    // Rules keep the input order; the last one is S' -> S
+    int RuleCount() const { return rule_lhs.size(); }
+    int AugmentedRule() const { return rule_lhs.size() - 1; }
+    int RuleLhs(int rule) const { return rule_lhs[rule]; }
+    Span RuleRhs(int rule) const;
+    std::string RuleText(int rule) const;
+    Span RulesOf(int non_terminal) const;
+
+    int ItemBase(int rule) const { return item_base[rule]; }
+    int ItemRule(int item) const { return item_rule[item]; }
+    int ItemDot(int item) const { return item - item_base[item_rule[item]]; }
+    int NextSymbol(int item) const { return next_symbol[item]; } // -1 at the end
+
+    int StateCount() const { return kernel_start.size() - 1; }
+    Span Kernel(int state) const;
+    // Pairs of (symbol, target state), sorted by symbol
+    Span Transitions(int state) const;
+    int Goto(int state, int symbol) const; // -1 if there is no transition
+    // All transitions are numbered in the order of Transitions()
+    int TransitionCount() const { return transitions.size() / 2; }
+    int FirstTransition(int state) const { return transition_start[state] / 2; } // up to that of state + 1
+    int TransitionIndex(int state, int symbol) const; // -1 if there is none
+    int TransitionSymbol(int index) const { return transitions[2 * index]; }
+    int TransitionTarget(int index) const { return transitions[2 * index + 1]; }
+    // Completed rules of a state; reduction r of state s has row
+    // ReductionIndex(s) + r in a lookahead table
+    Span Reductions(int state) const;
+    int ReductionIndex(int state) const { return reduction_start[state]; }
+    int ReductionCount() const { return reductions.size(); }
+
+    std::size_t KernelItemCount() const { return kernels.size(); }
+    std::size_t ClosureItemCount() const { return closure_items; }
+
+  private:
+    void InternGrammar(const CharacterType &c, const std::vector<Rule> &rules);
+    void BuildClosureCache();
+    void BuildStates();
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, int> ids;
+    int terminal_count;
+    std::vector<bool> nullable;
+
+    std::vector<int> rule_lhs;
+    std::vector<int> rule_start; // into rhs, one extra entry at the end
+    std::vector<int> rhs;
+    std::vector<std::vector<int>> rules_of; // per non terminal
+
+    std::vector<int> item_base;
+    std::vector<int> item_rule;
+    std::vector<int> next_symbol;
+    std::vector<std::vector<int>> closure_cache; // per non terminal
+
+    std::vector<int> kernel_start;
+    std::vector<int> kernels;
+    std::vector<int> transition_start;
+    std::vector<int> transitions;
+    std::vector<int> reduction_start;
+    std::vector<int> reductions;
+    std::size_t closure_items;
+};
+
+struct LRConflict
+// A terminal on which a state has more than one action
+{
+    int state;
+    int terminal;
+    int shift;   // target state, -1 for a reduce/reduce conflict
+    int first;   // first rule reduced on the terminal
+    int second;  // second rule reduced, -1 if there is only one
+    int reduces; // number of rules reduced on the terminal
+};
+
+// Lookaheads of every reduction taken from FOLLOW(lhs)
+Bitsets slrLookaheads(const LRAutomaton &automaton, const Fsets &follow_sets);
+std::vector<LRConflict> findConflicts(const LRAutomaton &automaton, const Bitsets &lookaheads);
+// Prints a summary line and at most "limit" conflicts
+void printConflicts(std::ostream &out, const char *name, const LRAutomaton &automaton, const std::vector<LRConflict> &conflicts, std::size_t limit = 20);
+
+#endif //__LR__H__
@@ -0,0 +1,237 @@
+/*
+ * Command line of the program: ./a.out <task> [options] < grammar, and the
+ * bench, serve and regress modes. Everything else is in the other
+ * translation units, so they can be linked into another program without
+ * this one (see grammarcontext.h).
+ */
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "grammarcontext.h"
+#include "llk.h"
+#include "output.h"
+#include "project2.h"
+#include "regress.h"
+#include "server.h"
+#include "stats.h"
+
+using namespace std;
+
+void syntax_error()
+{
+    cout << "SYNTAX ERROR !!!\n";
+    exit(1);
+}
+
+static bool stats_json = false;
+
+static void printStatsAtExit()
+{
+    cout.flush();
+    printStats(cerr, stats_json);
+}
+
+int main(int argc, char *argv[])
+{
+    int task;
+    bool reduce = false;
+    const char *sentences_file = nullptr;
+    int threads = 0;
+    OutputFormat format = OUTPUT_TEXT;
+    Task5Order task5_order = TASK5_ORDER_LEXICOGRAPHIC;
+    bool task5_report = false;
+    Task5Budget task5_budget;
+    int max_lookahead = LLK_MAX_K;
+    std::vector<std::string> symbols;
+
+    if (argc < 2)
+    {
+        cout << "Error: missing argument\n";
+        return 1;
+    }
+
+    /*
+       Note that by convention argv[0] is the name of your executable,
+       and the first argument to your program is stored in argv[1]
+     */
+
+    if (strcmp(argv[1], "bench") == 0)
+        return runBenchmark(argc - 1, argv + 1);
+    if (strcmp(argv[1], "serve") == 0)
+        return runServer(argc - 1, argv + 1);
+    if (strcmp(argv[1], "regress") == 0)
+        return runRegression(argc - 1, argv + 1);
+
+    task = atoi(argv[1]);
+    for (int i = 2; i < argc; i++)
+    {
+        // --stats and --stats=json write to standard error, also when the
+        // program exits early, so standard output is unchanged
+        if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=json") == 0)
+        {
+            stats_json = strcmp(argv[i], "--stats=json") == 0;
+            atexit(printStatsAtExit);
+        }
+        // --sentences=FILE gives the sentences for the recognizer tasks
+        else if (strncmp(argv[i], "--sentences=", 12) == 0)
+        {
+            sentences_file = argv[i] + 12;
+        }
+        // --threads=N sets how many threads lexing and task 8 use, default
+        // all cores
+        else if (strncmp(argv[i], "--threads=", 10) == 0)
+        {
+            threads = atoi(argv[i] + 10);
+        }
+        // --format=json or --format=binary writes tasks 1 to 5 for other
+        // programs to read (see structured.h)
+        else if (strncmp(argv[i], "--format=", 9) == 0)
+        {
+            if (!parseOutputFormat(argv[i] + 9, format))
+            {
+                cout << "Error: unknown format " << argv[i] + 9 << "\n";
+                return 1;
+            }
+        }
+        // --order=dependency makes task 5 pick its elimination order from
+        // the left corner graph (see task5order.h); both orders report the
+        // predicted and printed number of rules on standard error
+        else if (strncmp(argv[i], "--order=", 8) == 0)
+        {
+            if (strcmp(argv[i] + 8, "dependency") == 0)
+                task5_order = TASK5_ORDER_DEPENDENCY;
+            else if (strcmp(argv[i] + 8, "lexicographic") != 0)
+            {
+                cout << "Error: unknown order " << argv[i] + 8 << "\n";
+                return 1;
+            }
+            task5_report = true;
+        }
+        // --max-rules=N and --max-memory=MB limit what task 5 holds in
+        // memory; it prints rules as soon as they are final and stops with
+        // a report on standard error when it goes over
+        else if (strncmp(argv[i], "--max-rules=", 12) == 0)
+        {
+            task5_budget.max_rules = atol(argv[i] + 12);
+        }
+        else if (strncmp(argv[i], "--max-memory=", 13) == 0)
+        {
+            task5_budget.max_bytes = atoll(argv[i] + 13) << 20;
+        }
+        // --k=N is the largest lookahead task 9 tries
+        else if (strncmp(argv[i], "--k=", 4) == 0)
+        {
+            max_lookahead = atoi(argv[i] + 4);
+            if (max_lookahead < 1 || max_lookahead > LLK_MAX_K)
+            {
+                cout << "Error: --k must be from 1 to " << LLK_MAX_K << "\n";
+                return 1;
+            }
+        }
+        // --symbols=X,Y,... prints only those lines of task 2 or task 3
+        else if (strncmp(argv[i], "--symbols=", 10) == 0)
+        {
+            std::string list = argv[i] + 10;
+            size_t start = 0, comma;
+            while ((comma = list.find(',', start)) != std::string::npos)
+            {
+                symbols.push_back(list.substr(start, comma - start));
+                start = comma + 1;
+            }
+            symbols.push_back(list.substr(start));
+        }
+        // --reduce removes useless symbols first and reports what it removed
+        // on standard error
+        else if (strcmp(argv[i], "--reduce") == 0)
+        {
+            reduce = true;
+        }
+        else
+        {
+            cout << "Error: unrecognized option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    GrammarContext context;
+    context.SetThreads(threads);
+    if (context.Load(cin) != GRAMMAR_OK) // Reads the input grammar from standard input
+        syntax_error();                  // and represent it internally in data structures
+                                         // ad described in project 2 presentation file
+    if (reduce)
+    {
+        ReduceReport report = context.Reduce();
+        cerr << "reduce: removed " << report.symbols_removed << " symbols and "
+             << report.rules_removed << " rules (" << report.non_generating
+             << " non-generating, " << report.unreachable << " unreachable)\n";
+    }
+
+    if (sentences_file)
+    {
+        ifstream sentences(sentences_file);
+        if (!sentences)
+        {
+            cout << "Error: cannot open " << sentences_file << "\n";
+            return 1;
+        }
+        context.LoadSentences(sentences);
+    }
+    context.SetFormat(format);
+    context.SetTask5Order(task5_order);
+    context.SetTask5Budget(task5_budget);
+    context.SetMaxLookahead(max_lookahead);
+
+    StatsTimer task_timer(STATS_TASK);
+    GrammarStatus status;
+    if (!symbols.empty())
+        status = context.RunQuery(task, symbols, cout);
+    else
+        status = context.RunTask(task, cout);
+    task_timer.Stop();
+    if (task5_report && task == 5 && symbols.empty() && (status == GRAMMAR_OK || status == GRAMMAR_EPSILON_RULES))
+    {
+        const Task5Report &report = context.LastTask5Report();
+        cerr << "task5: " << (task5_order == TASK5_ORDER_DEPENDENCY ? "dependency" : "lexicographic")
+             << " order, predicted " << report.predicted_rules << " rules, printed " << report.rules << "\n";
+    }
+    if (status == GRAMMAR_BUDGET_EXCEEDED)
+    {
+        cout.flush();
+        const Task5Report &report = context.LastTask5Report();
+        cerr << "task5: over budget after " << report.non_terminals_done << " of " << report.non_terminals
+             << " non-terminals: " << report.held_rules << " rules (" << report.held_bytes << " bytes) held, "
+             << report.rules << " printed\n";
+        return 1;
+    }
+    if (status == GRAMMAR_OK && task == 5 && symbols.empty() && (task5_budget.max_rules > 0 || task5_budget.max_bytes > 0))
+    {
+        const Task5Report &report = context.LastTask5Report();
+        cerr << "task5: printed " << report.rules << " rules, at most " << report.peak_rules << " rules ("
+             << report.peak_bytes << " bytes) held\n";
+    }
+    if (status == GRAMMAR_BAD_TASK)
+        cout << "Error: unrecognized task number " << task << "\n";
+    else if (status == GRAMMAR_UNKNOWN_SYMBOL)
+    {
+        cout << "Error: unknown symbol in --symbols\n";
+        return 1;
+    }
+    else if (status == GRAMMAR_BAD_FORMAT)
+    {
+        cout << "Error: task " << task << " only writes text\n";
+        return 1;
+    }
+    else if (status == GRAMMAR_NO_SENTENCES)
+    {
+        cout << "Error: task " << task << " needs --sentences=FILE\n";
+        return 1;
+    }
+    else if (status != GRAMMAR_OK)
+        return 1;
+    return 0;
+}
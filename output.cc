@@ -0,0 +1,84 @@
+/*
+ * Buffered writer for task output.
+ */
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "output.h"
+
+using namespace std;
+
+bool parseOutputFormat(const string &name, OutputFormat &format)
+{
+    if (name == "text")
+        format = OUTPUT_TEXT;
+    else if (name == "json")
+        format = OUTPUT_JSON;
+    else if (name == "binary")
+        format = OUTPUT_BINARY;
+    else
+        return false;
+    return true;
+}
+
+OutputWriter::OutputWriter(ostream &out, size_t capacity) : out(&out), capacity(capacity)
+{
+    buffer.reserve(capacity);
+}
+
+OutputWriter::~OutputWriter()
+{
+    Flush();
+}
+
+void OutputWriter::Append(const char *s, size_t n)
+{
+    if (buffer.size() + n > capacity)
+        Flush();
+    if (n >= capacity)
+        out->write(s, n); // too big to be worth copying
+    else
+        buffer.append(s, n);
+}
+
+OutputWriter &OutputWriter::operator<<(const string &s)
+{
+    Append(s.data(), s.size());
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(const char *s)
+{
+    Append(s, strlen(s));
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(char c)
+{
+    if (buffer.size() + 1 > capacity)
+        Flush();
+    buffer.push_back(c);
+    return *this;
+}
+
+OutputWriter &OutputWriter::operator<<(long long n)
+{
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%lld", n);
+    Append(digits, length);
+    return *this;
+}
+
+void OutputWriter::Flush()
+// Hands the buffered text to the stream in one write, the buffer keeps its
+// capacity for the next chunk
+{
+    if (!buffer.empty())
+    {
+        out->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    out->flush();
+}
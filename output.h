@@ -0,0 +1,46 @@
+/*
+ * Buffered writer for task output.
+ *
+ * Text is formatted into one reusable buffer that is handed to the stream
+ * in large chunks, instead of one << (and often one flush) per symbol.
+ */
+#ifndef __OUTPUT__H__
+#define __OUTPUT__H__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+typedef enum {
+    OUTPUT_TEXT = 0,
+    OUTPUT_JSON, // see structured.h
+    OUTPUT_BINARY
+} OutputFormat;
+
+// "text", "json" or "binary"; false for anything else
+bool parseOutputFormat(const std::string &name, OutputFormat &format);
+
+class OutputWriter
+{
+  public:
+    explicit OutputWriter(std::ostream &out, std::size_t capacity = 1 << 20);
+    ~OutputWriter();
+
+    OutputWriter &operator<<(const std::string &s);
+    OutputWriter &operator<<(const char *s);
+    OutputWriter &operator<<(char c);
+    OutputWriter &operator<<(long long n);
+    void Flush();
+
+  private:
+    OutputWriter(const OutputWriter &) = delete;
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    void Append(const char *s, std::size_t n);
+
+    std::ostream *out;
+    std::string buffer;
+    std::size_t capacity;
+};
+
+#endif //__OUTPUT__H__
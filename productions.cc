@@ -0,0 +1,177 @@
+/*
+ * Hash-consed productions for the Task4 and Task5 rewrites.
+ */
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "productions.h"
+
+using namespace std;
+
+ProductionTable::ProductionTable() : rhs_bytes(0), production_ids(0, Hash{this}, Equal{this})
+{
+}
+
+SymbolId ProductionTable::Symbol(const string &name)
+{
+    auto found = symbol_ids.emplace(name, names.size());
+    if (found.second)
+        names.push_back(name);
+    return found.first->second;
+}
+
+size_t ProductionTable::Hash::operator()(ProductionId production) const
+{
+    const Production &p = table->productions[production];
+    size_t hash = p.lhs;
+    for (SymbolId symbol : p.rhs)
+        hash = hash * 1000003 ^ symbol;
+    return hash;
+}
+
+bool ProductionTable::Equal::operator()(ProductionId a, ProductionId b) const
+{
+    const Production &x = table->productions[a];
+    const Production &y = table->productions[b];
+    return x.lhs == y.lhs && x.rhs == y.rhs;
+}
+
+ProductionId ProductionTable::Add(SymbolId lhs, vector<SymbolId> rhs)
+// The production is appended first so that the set can hash it, and taken
+// back off if it was already there
+{
+    ProductionId id = productions.size();
+    productions.push_back({lhs, std::move(rhs)});
+    auto found = production_ids.insert(id);
+    if (!found.second)
+        productions.pop_back();
+    else
+        rhs_bytes += productions.back().rhs.capacity() * sizeof(SymbolId);
+    return *found.first;
+}
+
+void ProductionTable::Release(ProductionId production)
+{
+    auto found = production_ids.find(production);
+    if (found == production_ids.end() || *found != production)
+        return;
+    production_ids.erase(found);
+    vector<SymbolId> &rhs = productions[production].rhs;
+    rhs_bytes -= rhs.capacity() * sizeof(SymbolId);
+    vector<SymbolId>().swap(rhs);
+}
+
+size_t ProductionTable::MemoryBytes() const
+// The production slots, their right hand sides and a hash node of about
+// three words per live production
+{
+    return productions.capacity() * sizeof(Production) + rhs_bytes + Live() * 3 * sizeof(void *);
+}
+
+ProductionId ProductionTable::Add(const Rule &rule)
+{
+    vector<SymbolId> rhs;
+    rhs.reserve(rule.rhs.size());
+    for (const string &symbol : rule.rhs)
+        rhs.push_back(Symbol(symbol));
+    return Add(Symbol(rule.lhs), std::move(rhs));
+}
+
+bool ProductionTable::Less(ProductionId a, ProductionId b) const
+{
+    const Production &x = productions[a];
+    const Production &y = productions[b];
+    if (x.lhs != y.lhs)
+        return names[x.lhs] < names[y.lhs];
+    return lexicographical_compare(x.rhs.begin(), x.rhs.end(), y.rhs.begin(), y.rhs.end(),
+                                   [this](SymbolId s, SymbolId t)
+                                   { return names[s] < names[t]; });
+}
+
+int ProductionTable::Key(const vector<int> &symbol_rank, ProductionId production, size_t depth) const
+{
+    const Production &p = productions[production];
+    if (depth == 0)
+        return symbol_rank[p.lhs] + 1;
+    return depth <= p.rhs.size() ? symbol_rank[p.rhs[depth - 1]] + 1 : 0;
+}
+
+void ProductionTable::RadixSort(const vector<int> &symbol_rank, Range first, Range last, size_t depth, vector<ProductionId> &scratch) const
+// Distributes [first, last) by the key at depth and sorts every bucket by
+// the next key. Ranges too small for a pass over all the buckets are
+// sorted by comparing keys from depth on
+{
+    size_t n = last - first;
+    if (n < 2)
+        return;
+    size_t buckets = symbol_rank.size() + 1;
+    if (n < 64 || n * 4 < buckets)
+    {
+        sort(first, last, [&](ProductionId a, ProductionId b)
+             {
+                 for (size_t d = depth;; d++)
+                 {
+                     int x = Key(symbol_rank, a, d), y = Key(symbol_rank, b, d);
+                     if (x != y)
+                         return x < y;
+                     if (x == 0)
+                         return false;
+                 }
+             });
+        return;
+    }
+
+    vector<size_t> start(buckets + 1, 0);
+    for (Range it = first; it != last; ++it)
+        start[Key(symbol_rank, *it, depth) + 1]++;
+    for (size_t b = 0; b < buckets; b++)
+        start[b + 1] += start[b];
+    scratch.resize(n);
+    vector<size_t> next(start.begin(), start.end() - 1);
+    for (Range it = first; it != last; ++it)
+        scratch[next[Key(symbol_rank, *it, depth)]++] = *it;
+    copy(scratch.begin(), scratch.begin() + n, first);
+
+    // Bucket 0 holds the production that ended, there is at most one
+    for (size_t b = 1; b < buckets; b++)
+        RadixSort(symbol_rank, first + start[b], first + start[b + 1], depth + 1, scratch);
+}
+
+void ProductionTable::Sort(vector<ProductionId> &ids) const
+{
+    vector<SymbolId> by_name(names.size());
+    for (size_t s = 0; s < names.size(); s++)
+        by_name[s] = s;
+    sort(by_name.begin(), by_name.end(), [this](SymbolId a, SymbolId b)
+         { return names[a] < names[b]; });
+    vector<int> symbol_rank(names.size());
+    for (size_t r = 0; r < by_name.size(); r++)
+        symbol_rank[by_name[r]] = r;
+
+    vector<int> copies(productions.size(), 0);
+    vector<ProductionId> distinct;
+    for (ProductionId production : ids)
+    {
+        if (copies[production]++ == 0)
+            distinct.push_back(production);
+    }
+    vector<ProductionId> scratch;
+    RadixSort(symbol_rank, distinct.begin(), distinct.end(), 0, scratch);
+
+    ids.clear();
+    for (ProductionId production : distinct)
+        ids.insert(ids.end(), copies[production], production);
+}
+
+bool ProductionList::Add(ProductionId production)
+{
+    if (production >= (ProductionId)present.size())
+        present.resize(production + 1);
+    if (present[production])
+        return false;
+    present[production] = true;
+    ids.push_back(production);
+    return true;
+}
@@ -0,0 +1,108 @@
+/*
+ * Hash-consed productions for the Task4 and Task5 rewrites.
+ *
+ * A ProductionTable gives every symbol name and every distinct production
+ * lhs -> rhs a small integer. A production is stored once however many
+ * rules or copies refer to it, so two rules are the same production
+ * exactly when their ids are equal, and checking for a duplicate is a
+ * lookup by id instead of a comparison with every rule.
+ *
+ * Ids are given in order of first appearance. The tasks print rules in
+ * lexicographical order of their names (lhs, then rhs). Sort() ranks the
+ * symbols by name once and then sorts each distinct production once, with
+ * an MSD radix sort over its sequence of symbol ranks; copies of a
+ * production are put back next to it with a count.
+ */
+#ifndef __PRODUCTIONS__H__
+#define __PRODUCTIONS__H__
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "project2.h"
+
+typedef int SymbolId;
+typedef int ProductionId;
+
+class ProductionTable
+{
+  public:
+    ProductionTable();
+
+    // Id of the symbol with this name, added if it is new
+    SymbolId Symbol(const std::string &name);
+    const std::string &Name(SymbolId symbol) const { return names[symbol]; }
+    std::size_t Symbols() const { return names.size(); }
+
+    // Id of the production, added if it is new
+    ProductionId Add(SymbolId lhs, std::vector<SymbolId> rhs);
+    ProductionId Add(const Rule &rule);
+
+    SymbolId Lhs(ProductionId production) const { return productions[production].lhs; }
+    const std::vector<SymbolId> &Rhs(ProductionId production) const { return productions[production].rhs; }
+    std::size_t Size() const { return productions.size(); }
+
+    // Frees the right hand side of a production that no rule refers to
+    // anymore. The id stays taken; adding the production again gives a new one
+    void Release(ProductionId production);
+    // Productions not released, and an estimate of the memory they take
+    std::size_t Live() const { return production_ids.size(); }
+    std::size_t MemoryBytes() const;
+
+    // Whether a comes before b in lexicographical order of the names
+    bool Less(ProductionId a, ProductionId b) const;
+    // Sorts ids in the order the tasks print them, duplicates stay
+    void Sort(std::vector<ProductionId> &ids) const;
+
+  private:
+    struct Production
+    {
+        SymbolId lhs;
+        std::vector<SymbolId> rhs;
+    };
+    struct Hash
+    {
+        const ProductionTable *table;
+        std::size_t operator()(ProductionId production) const;
+    };
+    struct Equal
+    {
+        const ProductionTable *table;
+        bool operator()(ProductionId a, ProductionId b) const;
+    };
+
+    typedef std::vector<ProductionId>::iterator Range;
+
+    // Sort key of a production at depth 0 (lhs) or depth d (rhs[d - 1]):
+    // symbol rank + 1, or 0 past the end so that shorter rules come first
+    int Key(const std::vector<int> &symbol_rank, ProductionId production, std::size_t depth) const;
+    void RadixSort(const std::vector<int> &symbol_rank, Range first, Range last, std::size_t depth, std::vector<ProductionId> &scratch) const;
+
+    ProductionTable(const ProductionTable &) = delete;
+    ProductionTable &operator=(const ProductionTable &) = delete;
+
+    std::vector<std::string> names;
+    std::unordered_map<std::string, SymbolId> symbol_ids;
+    std::vector<Production> productions;
+    std::size_t rhs_bytes;
+    // Holds ids only; hashing and equality look at productions
+    std::unordered_set<ProductionId, Hash, Equal> production_ids;
+};
+
+class ProductionList
+// Distinct productions in the order they were added
+{
+  public:
+    // False if the production is already in the list
+    bool Add(ProductionId production);
+    const std::vector<ProductionId> &Ids() const { return ids; }
+
+  private:
+    std::vector<ProductionId> ids;
+    std::vector<bool> present;
+};
+
+#endif //__PRODUCTIONS__H__
@@ -9,45 +9,36 @@
  */
 
 #include <iostream>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <unordered_map>
+#include <unordered_set>
 #include "lexer.h"
+#include "project2.h"
+#include "firstof.h"
+#include "cyk.h"
+#include "earley.h"
+#include "lalr.h"
+#include "llk.h"
+#include "lr.h"
+#include "output.h"
+#include "productions.h"
+#include "sparseset.h"
+#include "stats.h"
+#include "structured.h"
+#include "task5order.h"
 #include <algorithm>
 #include <utility>
 #include <map>
+#include <memory>
 using namespace std;
-LexicalAnalyzer lexer;
 
-struct CharacterType
-// Structure to store terminals and non terminals
-{
-    std::vector<std::string> non_terminals;
-    std::vector<std::string> terminals;
-};
-
-struct Rule
-// Structure to define a Rule LHS -> RHS
-{
-    std::string lhs;
-    std::vector<std::string> rhs;
-};
-
-typedef std::unordered_map<std::string, std::vector<std::string>> Fsets;
-
-Fsets FirstSet;
-Fsets FollowSet;
-
-void syntax_error()
-{
-    cout << "SYNTAX ERROR !!!\n";
-    exit(1);
-}
-
-bool doesRuleExist(std::vector<Rule> &rules, std::string non_terminal)
+bool doesRuleExist(const std::vector<Rule> &rules, const std::string &non_terminal)
 // Function to check if a rule of a particular non terminal exists
 {
-    for (auto each_rule : rules)
+    for (const auto &each_rule : rules)
     {
         if (each_rule.lhs == non_terminal)
             return true;
@@ -56,250 +47,360 @@ bool doesRuleExist(std::vector<Rule> &rules, std::string non_terminal)
 }
 
 void addRule(std::vector<Rule> &rules, std::string lhs, vector<std::string> rhs)
-// Function to check if a rule of a particular non terminal exists
+// Function that appends the rule LHS -> RHS, taking ownership of both sides
 {
     Rule r;
-    if (!doesRuleExist(rules, lhs))
-    {
-        r.lhs = lhs;
-        r.rhs = rhs;
-        rules.push_back(r);
-        return;
-    }
-    r.lhs = lhs;
-
-    for (auto i : rhs)
-    {
-        r.rhs.push_back(i);
-    }
-    rules.push_back(r);
-    return;
+    r.lhs = std::move(lhs);
+    r.rhs = std::move(rhs);
+    rules.push_back(std::move(r));
 }
 
-Token expect(TokenType expected_type)
+// The parsing functions return false on a syntax error, the caller decides
+// what to do with it (main calls syntax_error)
+// Tokens are looked at through handles and PeekType() (see lexer.h), so
+// nothing is copied but the lexemes that go into the rules
+bool expect(LexicalAnalyzer &lexer, TokenType expected_type)
 {
-    Token t = lexer.GetToken();
-    if (t.token_type != expected_type)
-        syntax_error();
-    return t;
+    return lexer.NextToken().Type() == expected_type;
 }
 
-void readIdList(vector<std::string> &rhs_rule)
+bool readIdList(LexicalAnalyzer &lexer, vector<std::string> &rhs_rule)
 {
-    Token t = lexer.peek(1);
-    rhs_rule.push_back(t.lexeme);
-    expect(ID);
-    t = lexer.peek(1);
-    if (t.token_type == STAR)
-    {
-        return;
-    }
-    else if (t.token_type == ID)
+    while (true)
     {
-        readIdList(rhs_rule);
+        TokenHandle t = lexer.NextToken();
+        rhs_rule.emplace_back(t.Lexeme());
+        if (t.Type() != ID)
+            return false;
+        TokenType next = lexer.PeekType(1);
+        if (next == STAR)
+        {
+            return true;
+        }
+        else if (next != ID)
+            return false;
     }
-    else
-        syntax_error();
 }
-void readRHS(vector<std::string> &rhs_rule)
+
+bool readRHS(LexicalAnalyzer &lexer, vector<std::string> &rhs_rule)
 {
-    Token t = lexer.peek(1);
-    if (t.token_type == STAR)
+    TokenType t = lexer.PeekType(1);
+    if (t == STAR)
     {
         if (!rhs_rule.size())
             rhs_rule.push_back("#");
 
-        return;
+        return true;
     }
-    else if (t.token_type == ID)
+    else if (t == ID)
     {
-        readIdList(rhs_rule);
+        return readIdList(lexer, rhs_rule);
     }
 
     else
-        syntax_error();
+        return false;
 }
 
 // A -> A b B C
 //      ^
-void readRule(std::vector<Rule> &rules)
+bool readRule(LexicalAnalyzer &lexer, std::vector<Rule> &rules)
 {
 
-    Token t = lexer.peek(1);
-    std::string current_non_terminal;
-    current_non_terminal = t.lexeme; // A
-    expect(ID);
+    TokenHandle t = lexer.NextToken();
+    std::string current_non_terminal(t.Lexeme()); // A
+    if (t.Type() != ID)
+        return false;
 
-    expect(ARROW);
+    if (!expect(lexer, ARROW))
+        return false;
 
     vector<std::string> rhs_rule;
-    readRHS(rhs_rule);
+    if (!readRHS(lexer, rhs_rule))
+        return false;
 
-    addRule(rules, current_non_terminal, rhs_rule);
+    addRule(rules, std::move(current_non_terminal), std::move(rhs_rule));
 
-    expect(STAR);
+    return expect(lexer, STAR);
 }
 
-void readRuleList(std::vector<Rule> &rules)
+bool readRuleList(LexicalAnalyzer &lexer, std::vector<Rule> &rules)
 {
-    Token t = lexer.peek(1);
-    if (t.token_type == STAR)
-    {
-        expect(STAR);
-        return;
-    }
-    else if (t.token_type == ID)
+    while (true)
     {
-        readRule(rules);
-        readRuleList(rules);
-    }
-    else
-        return;
-}
-
-// read grammar
-void readGrammar(std::vector<Rule> &rules)
-{
-    readRuleList(rules);
-    expect(HASH);
-    expect(END_OF_FILE);
-}
-
-bool isNonTerminal(vector<std::string> non_terminals, string character)
-{
-    for (std::string str : non_terminals)
-    {
-        if (str == character)
+        TokenType t = lexer.PeekType(1);
+        if (t == STAR)
         {
-            return true;
+            return expect(lexer, STAR);
         }
+        else if (t == ID)
+        {
+            if (!readRule(lexer, rules))
+                return false;
+        }
+        else
+            return true;
     }
-    return false;
-}
-
-void addNonTerminal(vector<std::string> &non_terminals, string non_terminal)
-// Function that adds a non-terminal to the list of other non-terminals
-{
-    for (auto it : non_terminals)
-    {
-        if (it == non_terminal)
-            return;
-    }
-    non_terminals.push_back(non_terminal);
 }
 
-void addTerminal(vector<std::string> &terminals, string terminal)
-// Function that adds a non-terminal to the list of other non-terminals
+// read grammar
+bool readGrammar(LexicalAnalyzer &lexer, std::vector<Rule> &rules)
 {
-    for (auto it : terminals)
-    {
-        if (it == terminal)
-            return;
-    }
-    terminals.push_back(terminal);
+    return readRuleList(lexer, rules) && expect(lexer, HASH) && expect(lexer, END_OF_FILE);
 }
 
-CharacterType fetchTypes(std::vector<Rule> rules)
+CharacterType fetchTypes(const std::vector<Rule> &rules)
 // Function that finds terminals and non-terminals given a set of rules
 {
-    vector<std::string> non_terminals;
-    vector<std::string> final_non_terminals;
-    vector<std::string> terminals;
-    for (auto it : rules)
+    StatsTimer timer(STATS_FETCH_TYPES);
     // If any symbol on the RHS exists on the LHS, it is a non-terminal
-    {
-        bool exists = false;
-        for (auto rule : non_terminals)
-        {
-            if (rule == it.lhs)
-            {
-                exists = true;
-            }
-        }
-        if (!exists)
-            non_terminals.push_back(it.lhs);
-    }
+    std::unordered_set<std::string> non_terminals;
+    for (const auto &it : rules)
+        non_terminals.insert(it.lhs);
 
-    for (auto rule : rules)
+    CharacterType c;
+    std::unordered_set<std::string> seen;
+    for (const auto &rule : rules)
     {
         // Add all non terminals of the RHS to the existing list of non terminals
         // in the order of appearance
-        if (isNonTerminal(non_terminals, rule.lhs))
-            addNonTerminal(final_non_terminals, rule.lhs);
-        for (auto each_rhs_rule : rule.rhs)
+        if (seen.insert(rule.lhs).second)
+            c.non_terminals.push_back(rule.lhs);
+        for (const auto &each_rhs_rule : rule.rhs)
         {
             // if each symbol on the RHS of current rule is not a non-terminal, add it to terminal
             // and vice versa
-            if (!isNonTerminal(non_terminals, each_rhs_rule))
-            {
-                addTerminal(terminals, each_rhs_rule);
-            }
+            if (!seen.insert(each_rhs_rule).second)
+                continue;
+            if (non_terminals.count(each_rhs_rule))
+                c.non_terminals.push_back(each_rhs_rule);
             else
-            {
-                addNonTerminal(final_non_terminals, each_rhs_rule);
-            }
+                c.terminals.push_back(each_rhs_rule);
         }
     }
-    CharacterType c;
-    c.terminals = terminals;
-    c.non_terminals = final_non_terminals;
     return c;
 }
 
 // Task 1
-void Task1(std::vector<Rule> rules)
+void Task1(const std::vector<Rule> &rules, std::ostream &out, OutputFormat format)
 {
     // Fetch all terminals and non terminals
     CharacterType c = fetchTypes(rules);
+    if (format != OUTPUT_TEXT)
+    {
+        writeStructuredSymbols(out, format, c);
+        return;
+    }
+    OutputWriter output(out);
 
-    for (std::string t : c.terminals)
+    for (const std::string &t : c.terminals)
     {
         if (t != "#")
-            cout << t << " ";
+            output << t << ' ';
     }
 
-    for (std::string nt : c.non_terminals)
+    for (const std::string &nt : c.non_terminals)
     {
         if (nt != "#")
-            cout << nt << " ";
+            output << nt << ' ';
     }
 }
 
-bool customCompare(const std::string &left, const std::string &right, const std::vector<std::string> &order)
+struct SymbolOrder
+// Position of every symbol in the order of appearance, symbols that are not
+// in it go after all of the others
 {
-    if (left == "#")
+    static const size_t EPSILON = SIZE_MAX;
+    static const size_t END_OF_INPUT = SIZE_MAX - 1;
+
+    std::unordered_map<std::string, size_t> position;
+    size_t missing;
+
+    explicit SymbolOrder(const std::vector<std::string> &order) : missing(order.size())
+    {
+        position.reserve(order.size());
+        for (size_t i = 0; i < order.size(); i++)
+            position.emplace(order[i], i);
+    }
+
+    // What customCompare compares, "#" and "$" get keys of their own
+    size_t Key(const std::string &symbol) const
+    {
+        if (symbol == "#")
+            return EPSILON;
+        if (symbol == "$")
+            return END_OF_INPUT;
+        auto it = position.find(symbol);
+        return it == position.end() ? missing : it->second;
+    }
+};
+
+bool customCompare(size_t left, size_t right)
+{
+    if (left == SymbolOrder::EPSILON)
         return false;
-    if (right == "#")
+    if (right == SymbolOrder::EPSILON)
         return false;
-    if (left == "$")
+    if (left == SymbolOrder::END_OF_INPUT)
         return true;
-    if (right == "$")
+    if (right == SymbolOrder::END_OF_INPUT)
         return false;
 
-    auto leftPos = std::find(order.begin(), order.end(), left);
-    auto rightPos = std::find(order.begin(), order.end(), right);
-    return std::distance(order.begin(), leftPos) < std::distance(order.begin(), rightPos);
+    return left < right;
 }
 
-void sortStringVectorsInMap(Fsets &mapOfVectors, const std::vector<std::string> &order)
+void sortSet(std::vector<std::string> &vec, const SymbolOrder &order)
+// Function that sorts on keys looked up once per element, the comparisons
+// give the same answers as comparing the names
+{
+    std::vector<std::pair<size_t, std::string>> keyed;
+    keyed.reserve(vec.size());
+    for (auto &symbol : vec)
+        keyed.emplace_back(order.Key(symbol), std::move(symbol));
+    std::sort(keyed.begin(), keyed.end(), [](const std::pair<size_t, std::string> &left, const std::pair<size_t, std::string> &right)
+              { return customCompare(left.first, right.first); });
+    for (size_t i = 0; i < vec.size(); i++)
+        vec[i] = std::move(keyed[i].second);
+}
+
+const std::vector<std::string> &lookupSet(const Fsets &sets, const std::string &symbol)
+// Function that returns the set of a symbol without inserting into the map
+{
+    static const std::vector<std::string> empty_set;
+    auto it = sets.find(symbol);
+    if (it == sets.end())
+        return empty_set;
+    return it->second;
+}
+
+struct SparseFirst
+// FIRST set of one symbol on a large alphabet, elements are terminal numbers
+{
+    bool nullable;
+    std::vector<int> elements; // in the order they were added
+    SparseSet members;
+};
+
+static void fillFirstSetsSparse(const CharacterType &c, const std::vector<Rule> &rules, Fsets &FirstSet)
+// Function that does the work of findFirstSets with symbol numbers and
+// sparse sets. It adds elements in the same order the loop over names does,
+// so the sets come out the same, only membership tests are cheaper.
 {
-    for (auto &entry : mapOfVectors)
+    // Terminals are numbered first, terminal t is also element t of the sets
+    std::unordered_map<std::string, int> number;
+    std::vector<const std::string *> names;
+    for (const auto &terminal : c.terminals)
+    {
+        number.emplace(terminal, names.size());
+        names.push_back(&terminal);
+    }
+    for (const auto &non_terminal : c.non_terminals)
     {
-        std::vector<std::string> &vec = entry.second;
-        std::sort(vec.begin(), vec.end(), [&order](const std::string &left, const std::string &right)
-                  { return customCompare(left, right, order); });
+        number.emplace(non_terminal, names.size());
+        names.push_back(&non_terminal);
+    }
+
+    std::vector<SparseFirst> first(names.size());
+    for (size_t t = 0; t < c.terminals.size(); t++)
+    {
+        // FIRST(#) = { # } is empty and nullable
+        first[t].nullable = c.terminals[t] == "#";
+        if (!first[t].nullable)
+        {
+            first[t].elements.push_back(t);
+            first[t].members.Insert(t);
+        }
+    }
+    for (size_t n = c.terminals.size(); n < names.size(); n++)
+        first[n].nullable = false;
+
+    std::vector<std::vector<int>> rhs_numbers(rules.size());
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        for (const auto &symbol : rules[r].rhs)
+            rhs_numbers[r].push_back(number.at(symbol));
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        stats.first_passes++;
+        for (size_t r = 0; r < rules.size(); r++)
+        {
+            int lhs = number.at(rules[r].lhs);
+            SparseFirst &lhs_first = first[lhs];
+            size_t original_size = lhs_first.elements.size() + lhs_first.nullable;
+
+            bool epsilon_in_all = false;
+            bool skip_rule = false;
+            for (int each_rhs : rhs_numbers[r])
+            {
+                const SparseFirst &current = first[each_rhs];
+                // FIRST(lhs) on the RHS is read as it was before this rule
+                size_t current_size = each_rhs == lhs ? original_size : current.elements.size() + current.nullable;
+                if (current_size == 0)
+                {
+                    epsilon_in_all = false;
+                    skip_rule = true;
+                    break;
+                }
+
+                if (each_rhs != lhs && !lhs_first.members.Includes(current.members))
+                {
+                    for (int element : current.elements)
+                    {
+                        if (lhs_first.members.Insert(element))
+                            lhs_first.elements.push_back(element);
+                    }
+                }
+                epsilon_in_all = current.nullable;
+                if (!epsilon_in_all)
+                    break;
+            }
+            if (skip_rule && lhs_first.elements.empty() && !lhs_first.nullable)
+            {
+                continue;
+            }
+            if (epsilon_in_all)
+                lhs_first.nullable = true;
+            size_t size = lhs_first.elements.size() + lhs_first.nullable;
+            if (original_size != size)
+            {
+                changed = true;
+                stats.first_insertions += size - original_size;
+            }
+        }
+    }
+
+    for (size_t s = 0; s < names.size(); s++)
+    {
+        // # goes on the extreme left
+        std::vector<std::string> &set = FirstSet[*names[s]];
+        set.clear();
+        set.reserve(first[s].elements.size() + first[s].nullable);
+        if (first[s].nullable)
+            set.push_back("#");
+        for (int element : first[s].elements)
+            set.push_back(*names[element]);
     }
 }
 
-Fsets findFirstSets(CharacterType c, std::vector<Rule> rules)
+void findFirstSets(const CharacterType &c, const std::vector<Rule> &rules, Fsets &FirstSet)
+// Function that fills FirstSet with FIRST of every terminal and non terminal
 {
-    for (auto terminal : c.terminals)
+    StatsTimer timer(STATS_FIRST_SETS);
+    if (c.terminals.size() >= SPARSE_SET_MIN_TERMINALS)
+    {
+        fillFirstSetsSparse(c, rules, FirstSet);
+        return;
+    }
+    for (const auto &terminal : c.terminals)
     //Initialize First sets of all terminals as themselves
     {
         FirstSet[terminal] = {terminal};
     }
 
-    for (auto non_terminals : c.non_terminals)
+    for (const auto &non_terminals : c.non_terminals)
     //Initialize First sets of all non-terminals as empty
     {
         FirstSet[non_terminals] = {};
@@ -309,18 +410,21 @@ Fsets findFirstSets(CharacterType c, std::vector<Rule> rules)
     //Algorithm keeps proceeding as long as there is any change in any first set
     {
         changed = false;
-        for (auto rule : rules)
+        stats.first_passes++;
+        for (const auto &rule : rules)
         {
-            std::string lhs = rule.lhs;
-            std::vector<std::string> rhs = rule.rhs;
+            const std::string &lhs = rule.lhs;
+            const std::vector<std::string> &rhs = rule.rhs;
+            // Work on a copy, the RHS may read FIRST(lhs) itself
             std::vector<std::string> current_LHS_set = FirstSet[lhs];
-            std::vector<std::string> original_set = current_LHS_set;
+            // Sets only grow, so a change shows up as a change in size
+            size_t original_size = current_LHS_set.size();
 
             bool epsilon_in_all = false;
             bool skip_rule = false;
-            for (auto each_rhs : rhs)
+            for (const auto &each_rhs : rhs)
             {
-                std::vector<std::string> current_first_set = FirstSet[each_rhs];
+                const std::vector<std::string> &current_first_set = FirstSet[each_rhs];
                 if (current_first_set.empty())
                 {
                     epsilon_in_all = false;
@@ -328,7 +432,7 @@ Fsets findFirstSets(CharacterType c, std::vector<Rule> rules)
                     break;
                 }
 
-                for (auto each_rhs_first : current_first_set)
+                for (const auto &each_rhs_first : current_first_set)
                 {
 
                     if (each_rhs_first != "#")
@@ -357,31 +461,131 @@ Fsets findFirstSets(CharacterType c, std::vector<Rule> rules)
             }
             if (epsilon_in_all)
             {
-                std::vector<std::string> original_set = current_LHS_set;
-                std::vector<std::string> epsilon_set = {"#"};
-                for (auto each_element : current_LHS_set)
-                {
-                    auto it = std::find(epsilon_set.begin(), epsilon_set.end(), each_element);
-                    if (it == epsilon_set.end())
-                    {
-                        epsilon_set.push_back(each_element);
-                    }
-                }
-
-                current_LHS_set = epsilon_set;
+                // # goes on the extreme left
+                auto it = std::find(current_LHS_set.begin(), current_LHS_set.end(), "#");
+                if (it == current_LHS_set.end())
+                    current_LHS_set.insert(current_LHS_set.begin(), "#");
             }
-            if (original_set != current_LHS_set)
+            if (original_size != current_LHS_set.size())
+            {
                 changed = true;
+                stats.first_insertions += current_LHS_set.size() - original_size;
+                FirstSet[lhs] = std::move(current_LHS_set);
+            }
+        }
+    }
+}
+
+static void fillFollowSetsSparse(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, const FirstOfTable &suffixes, Fsets &FollowSet)
+// Function that does the work of fillFollowSets with sparse sets, whole
+// sets are copied with one union instead of one search per element
+{
+    // Elements are numbered "$" first and then the terminals
+    std::unordered_map<std::string, int> element_number;
+    std::vector<const std::string *> elements;
+    static const std::string end_marker = "$";
+    element_number.emplace(end_marker, 0);
+    elements.push_back(&end_marker);
+    for (const auto &terminal : c.terminals)
+    {
+        FollowSet[terminal] = {};
+        if (terminal != "#" && element_number.emplace(terminal, elements.size()).second)
+            elements.push_back(&terminal);
+    }
+
+    // Anything that is not a non terminal stops the copying like a terminal
+    std::unordered_map<std::string, int> non_terminal;
+    std::vector<bool> nullable(c.non_terminals.size());
+    for (size_t n = 0; n < c.non_terminals.size(); n++)
+    {
+        non_terminal.emplace(c.non_terminals[n], n);
+        const std::vector<std::string> &first_set = lookupSet(FirstSet, c.non_terminals[n]);
+        nullable[n] = std::find(first_set.begin(), first_set.end(), "#") != first_set.end();
+    }
+    auto symbolNumber = [&non_terminal](const std::string &symbol)
+    {
+        auto it = non_terminal.find(symbol);
+        return it == non_terminal.end() ? -1 : it->second;
+    };
+
+    std::vector<SparseSet> follow(c.non_terminals.size());
+    if (!follow.empty())
+        follow[0].Insert(0);
 
-            FirstSet[lhs] = current_LHS_set;
+    // FIRST(rest of the rule) goes into FOLLOW of every non terminal
+    std::vector<int> suffix_element;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        const std::vector<std::string> &rhs = rules[r].rhs;
+        for (size_t i = 0; i + 1 < rhs.size(); i++)
+        {
+            int n = symbolNumber(rhs[i]);
+            if (n < 0)
+                continue;
+            for (int id : suffixes.SuffixFirst(r, i + 1))
+            {
+                if ((size_t)id >= suffix_element.size())
+                    suffix_element.resize(id + 1, -1);
+                if (suffix_element[id] < 0)
+                    suffix_element[id] = element_number.at(suffixes.Symbol(id));
+                if (follow[n].Insert(suffix_element[id]))
+                    stats.follow_insertions++;
+            }
         }
     }
-    return FirstSet;
+
+    std::vector<int> lhs_numbers(rules.size());
+    std::vector<std::vector<int>> rhs_numbers(rules.size());
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        lhs_numbers[r] = symbolNumber(rules[r].lhs);
+        for (const auto &symbol : rules[r].rhs)
+            rhs_numbers[r].push_back(symbolNumber(symbol));
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        stats.follow_passes++;
+        for (size_t r = 0; r < rules.size(); r++)
+        {
+            const SparseSet &lhs_set = follow[lhs_numbers[r]];
+            const std::vector<int> &rhs = rhs_numbers[r];
+            for (int i = rhs.size() - 1; i > -1; i--)
+            {
+                // If met with a terminal stop this rule
+                if (lhs_set.Empty() || rhs[i] < 0)
+                    break;
+                size_t added = follow[rhs[i]].UnionWith(lhs_set);
+                stats.follow_insertions += added;
+                if (added)
+                    changed = true;
+                if (!nullable[rhs[i]])
+                    break;
+            }
+        }
+    }
+
+    for (size_t n = 0; n < c.non_terminals.size(); n++)
+    {
+        std::vector<std::string> &set = FollowSet[c.non_terminals[n]];
+        set.clear();
+        set.reserve(follow[n].Size());
+        follow[n].ForEach([&](uint32_t element)
+                          { set.push_back(*elements[element]); });
+    }
 }
 
-Fsets findFollowSets(CharacterType c, std::vector<Rule> rules, Fsets FirstSet)
+static void fillFollowSets(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, const FirstOfTable &suffixes, Fsets &FollowSet)
+// Function that does the work of both findFollowSets
 {
-    for (auto terminal : c.terminals)
+    if (c.terminals.size() >= SPARSE_SET_MIN_TERMINALS)
+    {
+        fillFollowSetsSparse(c, rules, FirstSet, suffixes, FollowSet);
+        return;
+    }
+    for (const auto &terminal : c.terminals)
     {
         FollowSet[terminal] = {};
     }
@@ -398,83 +602,69 @@ Fsets findFollowSets(CharacterType c, std::vector<Rule> rules, Fsets FirstSet)
         }
     }
 
-    for (auto rule : rules)
+    for (size_t r = 0; r < rules.size(); r++)
     {
-        std::vector<std::string> rhs = rule.rhs;
-        for (int i = 0; i < rhs.size() - 1; i++)
+        const std::vector<std::string> &rhs = rules[r].rhs;
+        for (size_t i = 0; i + 1 < rhs.size(); i++)
         {
             auto it = std::find(c.terminals.begin(), c.terminals.end(), rhs[i]);
             if (it != c.terminals.end())
             {
                 continue;
             }
-            std::vector<std::string> current_set = {};
-
-            for (int j = i + 1; j < rhs.size(); j++)
+            std::vector<std::string> &follow_set = FollowSet[rhs[i]];
+            for (int id : suffixes.SuffixFirst(r, i + 1))
             {
-                bool epsilon_found = false;
-                for (int k = 0; k < FirstSet[rhs[j]].size(); k++)
-                {
-                    auto it = std::find(current_set.begin(), current_set.end(), FirstSet[rhs[j]][k]);
-                    if (it == current_set.end())
-                    {
-                        if (FirstSet[rhs[j]][k] == "#")
-                        {
-                            epsilon_found = true;
-                            continue;
-                        }
-                        current_set.push_back(FirstSet[rhs[j]][k]);
-                    }
-                }
-                if (epsilon_found)
-                {
-                    continue;
-                }
-                else
+                const std::string &x = suffixes.Symbol(id);
+                auto it = std::find(follow_set.begin(), follow_set.end(), x);
+                if (it == follow_set.end())
                 {
-                    break;
+                    follow_set.push_back(x);
+                    stats.follow_insertions++;
                 }
             }
-            for (auto x : current_set)
-            {
-                auto it = std::find(FollowSet[rhs[i]].begin(), FollowSet[rhs[i]].end(), x);
-                if (it == FollowSet[rhs[i]].end())
-                    FollowSet[rhs[i]].push_back(x);
-            }
         }
     }
     bool changed = true;
     while (changed)
     {
         changed = false;
-        for (auto rule : rules)
+        stats.follow_passes++;
+        for (const auto &rule : rules)
         {
-            std::string lhs = rule.lhs;
-            std::vector<std::string> rhs = rule.rhs;
+            const std::string &lhs = rule.lhs;
+            const std::vector<std::string> &rhs = rule.rhs;
             int size_of_rhs = rhs.size();
             for (int i = size_of_rhs - 1; i > -1; i--)
             {
                 auto iterator = std::find(c.terminals.begin(), c.terminals.end(), rhs[i]);
+                const std::vector<std::string> &lhs_set = FollowSet[lhs];
 
                 // If met with a terminal stop this rule
-                if (FollowSet[lhs].empty() || iterator != c.terminals.end())
+                if (lhs_set.empty() || iterator != c.terminals.end())
                 {
                     break;
                 }
 
-                std::vector<std::string> original_rhs = FollowSet[rhs[i]];
+                std::vector<std::string> &rhs_set = FollowSet[rhs[i]];
+                // Sets only grow, so a change shows up as a change in size
+                size_t original_size = rhs_set.size();
 
                 // Copying values of LHS to RHS
-                for (auto each_set_item : FollowSet[lhs])
+                for (size_t k = 0; k < lhs_set.size(); k++)
                 {
-                    auto it = std::find(FollowSet[rhs[i]].begin(), FollowSet[rhs[i]].end(), each_set_item);
-                    if (it == FollowSet[rhs[i]].end())
-                        FollowSet[rhs[i]].push_back(each_set_item);
+                    auto it = std::find(rhs_set.begin(), rhs_set.end(), lhs_set[k]);
+                    if (it == rhs_set.end())
+                    {
+                        rhs_set.push_back(lhs_set[k]);
+                        stats.follow_insertions++;
+                    }
                 }
-                auto it = std::find(FirstSet[rhs[i]].begin(), FirstSet[rhs[i]].end(), "#");
-                if (original_rhs != FollowSet[rhs[i]])
+                const std::vector<std::string> &first_set = lookupSet(FirstSet, rhs[i]);
+                auto it = std::find(first_set.begin(), first_set.end(), "#");
+                if (original_size != rhs_set.size())
                     changed = true;
-                if (it == FirstSet[rhs[i]].end())
+                if (it == first_set.end())
                 {
 
                     break;
@@ -486,451 +676,564 @@ Fsets findFollowSets(CharacterType c, std::vector<Rule> rules, Fsets FirstSet)
             }
         }
     }
-    return FollowSet;
 }
 
-// Task 2
-void Task2(CharacterType c, std::vector<Rule> rules)
+void findFollowSets(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, Fsets &FollowSet)
+// Function that fills FollowSet given the sets computed by findFirstSets
 {
-    // Find first sets of all rules
-    FirstSet = findFirstSets(c, rules);
-
-    // Sorting to ensure order of appearance and # on the extreme left
-    sortStringVectorsInMap(FirstSet, c.terminals);
-    for (auto it : c.non_terminals)
-    {
-        cout << "FIRST(" << it << ") = { ";
-        if (FirstSet[it].size() > 0)
-        {
-            for (int j = 0; j < FirstSet[it].size() - 1; j++)
-            {
-                cout << FirstSet[it][j] << ", ";
-            }
-            cout << FirstSet[it][FirstSet[it].size() - 1];
-        }
-        cout << " }" << endl;
-    }
-    cout << endl;
+    StatsTimer timer(STATS_FOLLOW_SETS);
+    FirstOfTable suffixes(rules, FirstSet);
+    fillFollowSets(c, rules, FirstSet, suffixes, FollowSet);
 }
 
-Fsets formatForTask3(Fsets FollowSets, std::vector<std::string> terminals)
-{   
-
-    // Sorting to ensure order of appearance and $ on the extreme left
-    sortStringVectorsInMap(FollowSets, terminals);
-    for (auto f : FollowSets)
-    {
-
-        std::vector<std::string> elements = FollowSets[f.first];
-        auto iter = std::find(elements.begin(), elements.end(), "$");
-        if (iter != elements.end())
-        {
-            std::vector<std::string> temp_vec = {"$"};
-            for (auto x : elements)
-            {
-                if (x != "$")
-                {
-                    temp_vec.push_back(x);
-                }
-            }
-            FollowSets[f.first] = temp_vec;
-        }
-    }
-
-    return FollowSets;
+void findFollowSets(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, const FirstOfTable &suffixes, Fsets &FollowSet)
+// Function that fills FollowSet, FIRST of the rule suffixes comes from the table
+{
+    StatsTimer timer(STATS_FOLLOW_SETS);
+    fillFollowSets(c, rules, FirstSet, suffixes, FollowSet);
 }
 
-// Task 3
-void Task3(CharacterType c, std::vector<Rule> rules)
+void printSet(OutputWriter &output, const char *name, const std::string &symbol, const std::vector<std::string> &set)
+// Function that prints NAME(X) = { ... }
 {
-    //Find first sets
-    Fsets first_sets = findFirstSets(c, rules);
-    //Find follow sets
-    FollowSet = findFollowSets(c, rules, first_sets);
-    //Format follow sets as required the output
-    Fsets FollowSets = formatForTask3(FollowSet, c.terminals);
-
-    for (auto it : c.non_terminals)
+    output << name << '(' << symbol << ") = { ";
+    if (set.size() > 0)
     {
-        cout << "FOLLOW(" << it << ") = { ";
-        if (FollowSets[it].size() > 0)
+        for (int j = 0; j < set.size() - 1; j++)
         {
-            for (int j = 0; j < FollowSets[it].size() - 1; j++)
-            {
-                cout << FollowSets[it][j] << ", ";
-            }
-            cout << FollowSets[it][FollowSets[it].size() - 1];
+            output << set[j] << ", ";
         }
-        cout << " }" << endl;
+        output << set[set.size() - 1];
     }
+    output << " }\n";
 }
 
-bool sortRulesComparator(Rule a, Rule b)
+void sortFirstSet(std::vector<std::string> &set, const CharacterType &c)
 {
+    sortSet(set, SymbolOrder(c.terminals));
+}
 
-    if (a.lhs < b.lhs)
-    {
-        return true;
-    }
-    else if (a.lhs > b.lhs)
-        return false;
-    else if (a.lhs == b.lhs)
+void formatFollowSet(std::vector<std::string> &elements, const SymbolOrder &order)
+{
+    // Sorting to ensure order of appearance and $ on the extreme left
+    sortSet(elements, order);
+    auto iter = std::find(elements.begin(), elements.end(), "$");
+    if (iter != elements.end())
     {
-        return a.rhs < b.rhs;
+        // Move $ to the front, keeping the order of the others
+        std::rotate(elements.begin(), iter, iter + 1);
     }
 }
 
-void removeFromRules(std::vector<Rule> &rules, Rule rule)
+void sortFollowSet(std::vector<std::string> &set, const CharacterType &c)
 {
-    std::vector<Rule> temp;
-    for (auto x : rules)
-    {
-        if (x.lhs == rule.lhs && x.rhs == rule.rhs)
-            continue;
-        temp.push_back(x);
-    }
-    rules = temp;
+    formatFollowSet(set, SymbolOrder(c.terminals));
 }
 
-void addToRules(std::vector<Rule> &rules, Rule rule)
+void printSortedSets(OutputWriter &output, const char *name, const CharacterType &c, const Fsets &sets, bool follow)
+// Function that prints NAME(X) = { ... } for every non terminal X, each set
+// sorted on a copy the way Task2 (or Task3 with follow) prints it
 {
-    bool duplicate = false;
-    for (auto r : rules)
+    SymbolOrder order(c.terminals);
+    std::vector<std::string> sorted;
+    for (const auto &it : c.non_terminals)
     {
-        if (r.lhs == rule.lhs && r.rhs == rule.rhs)
-        {
-            duplicate = true;
-            break;
-        }
+        const std::vector<std::string> &set = lookupSet(sets, it);
+        sorted.assign(set.begin(), set.end());
+        if (follow)
+            formatFollowSet(sorted, order);
+        else
+            sortSet(sorted, order);
+        printSet(output, name, it, sorted);
     }
-    if (!duplicate)
-        rules.push_back(rule);
 }
 
-void task4PrintRules(std::vector<Rule> rules)
+// Task 2
+void Task2(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out, OutputFormat format)
 {
+    // Find first sets of all rules
+    Fsets FirstSet;
+    findFirstSets(c, rules, FirstSet);
+    Task2(c, FirstSet, out, format);
+}
 
-    for (const auto &pair : rules)
+void Task2(const CharacterType &c, const Fsets &FirstSet, std::ostream &out, OutputFormat format)
+{
+    if (format != OUTPUT_TEXT)
     {
-        if (pair.rhs.size() < 0)
-            continue;
-        std::cout << pair.lhs << " -> ";
-
-        for (const std::string &value : pair.rhs)
-        {
-            if (value == "#")
-                continue;
-            std::cout << value << " ";
-        }
-        std::cout << "#";
-        std::cout << std::endl;
+        writeStructuredSets(out, format, 2, c, FirstSet);
+        return;
     }
+
+    // Sorting to ensure order of appearance and # on the extreme left
+    OutputWriter output(out);
+    printSortedSets(output, "FIRST", c, FirstSet, false);
+    output << '\n';
 }
 
-struct Task4LongestMatch
+// Task 3
+void Task3(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out, OutputFormat format)
 {
-    Rule rule;
-    int longest_match;
-};
+    //Find first sets
+    Fsets first_sets;
+    findFirstSets(c, rules, first_sets);
+    //Find follow sets
+    Fsets FollowSet;
+    findFollowSets(c, rules, first_sets, FollowSet);
+    Task3(c, FollowSet, out, format);
+}
 
-std::vector<std::string> task4ExtractPrefixOfSize(Rule rule, int prefix_size)
+void Task3(const CharacterType &c, const Fsets &FollowSet, std::ostream &out, OutputFormat format)
 {
-    std::vector<std::string> extracted_prefix;
-    if (prefix_size > rule.rhs.size())
-        return {};
-    for (int i = 0; i < prefix_size; i++)
+    if (format != OUTPUT_TEXT)
     {
-        extracted_prefix.push_back(rule.rhs[i]);
+        writeStructuredSets(out, format, 3, c, FollowSet);
+        return;
     }
-    return extracted_prefix;
+    //Format follow sets as required the output
+    OutputWriter output(out);
+    printSortedSets(output, "FOLLOW", c, FollowSet, true);
 }
 
-bool sortTask4LongestMatch(Task4LongestMatch a, Task4LongestMatch b)
+void removeFromRules(std::vector<ProductionId> &rules, std::vector<bool> &in_rules, const std::vector<ProductionId> &removed)
+// Function that removes every copy of the removed productions, the order of the others is kept
 {
+    for (ProductionId production : removed)
+        in_rules[production] = false;
+    auto last = std::remove_if(rules.begin(), rules.end(), [&in_rules](ProductionId production)
+                               { return !in_rules[production]; });
+    rules.erase(last, rules.end());
+}
 
-    return a.longest_match > b.longest_match;
+void addToRules(std::vector<ProductionId> &rules, std::vector<bool> &in_rules, ProductionId production)
+// Function that appends production unless rules already has it
+{
+    if ((size_t)production >= in_rules.size())
+        in_rules.resize(production + 1);
+    if (in_rules[production])
+        return;
+    in_rules[production] = true;
+    rules.push_back(production);
 }
 
-bool sortTask4Lexicographical(Task4LongestMatch a, Task4LongestMatch b)
+void task4PrintRules(const ProductionTable &table, const std::vector<ProductionId> &rules, std::ostream &out)
 {
+    OutputWriter output(out);
 
-    if (a.longest_match != b.longest_match)
-    {
-        return a.longest_match > b.longest_match;
-    }
-    else
+    for (ProductionId production : rules)
     {
-        // If longest_match is the same, compare the entire Rule (LHS + RHS)
-        std::vector<std::string> rule_1 = a.rule.rhs;
-        rule_1.insert(rule_1.begin(), a.rule.lhs);
+        output << table.Name(table.Lhs(production)) << " -> ";
 
-        std::vector<std::string> rule_2 = b.rule.rhs;
-        rule_2.insert(rule_2.begin(), b.rule.lhs);
-
-        return rule_1 < rule_2;
+        for (SymbolId symbol : table.Rhs(production))
+        {
+            const std::string &value = table.Name(symbol);
+            if (value == "#")
+                continue;
+            output << value << ' ';
+        }
+        output << "#\n";
     }
 }
 
-void task4SplitRules(std::string non_terminal, std::vector<Rule> rules, std::vector<Rule> &common_group, std::vector<Rule> &uncommon_group, std::vector<std::string> &suffix)
+bool task4HasPrefix(const std::vector<SymbolId> &rhs, const std::vector<SymbolId> &prefix)
 {
-    std::vector<Rule> selected_rules;
-    std::vector<Task4LongestMatch> all_matches;
+    if (prefix.size() > rhs.size())
+        return prefix.empty();
+    return std::equal(prefix.begin(), prefix.end(), rhs.begin());
+}
+
+void task4SplitRules(const ProductionTable &table, SymbolId non_terminal, const std::vector<ProductionId> &rules, std::vector<ProductionId> &common_group, std::vector<SymbolId> &prefix)
+// Function that finds the longest prefix ⍺ shared by two rules of non_terminal
+// and the rules that begin with it; common_group stays empty if there is none
+{
+    std::vector<ProductionId> selected_rules;
     // Select all rules of selected non terminal
-    for (int i = 0; i < rules.size(); i++)
+    for (ProductionId production : rules)
     {
-
-        if (rules[i].lhs == non_terminal)
-        {
-            selected_rules.push_back(rules[i]);
-        }
+        if (table.Lhs(production) == non_terminal)
+            selected_rules.push_back(production);
     }
 
-    // find longest prefix
-    for (int i = 0; i < selected_rules.size(); i++)
+    // find longest prefix of every rule with any other rule
+    std::vector<int> longest_match(selected_rules.size(), 0);
+    for (size_t i = 0; i < selected_rules.size(); i++)
     {
-        Rule first_rule = selected_rules[i];
-        Task4LongestMatch m;
-        m.rule = first_rule;
-        int longest_match_for_first_rule = 0;
-        for (int j = 0; j < selected_rules.size(); j++)
+        const std::vector<SymbolId> &first_rhs = table.Rhs(selected_rules[i]);
+        for (size_t j = i + 1; j < selected_rules.size(); j++)
         {
-            // skipping the same rule
-            if (i == j)
-                continue;
-
-            Rule second_rule = selected_rules[j];
-
-            int minimum_of_two = min(first_rule.rhs.size(), second_rule.rhs.size());
-            int longest_match_with_current_rule = 0;
-
-            for (int k = 0; k < minimum_of_two; k++)
-            {
-                if (first_rule.rhs[k] == second_rule.rhs[k])
-                {
-                    ++longest_match_with_current_rule;
-                }
-                else
-                    break;
-            }
-
-            longest_match_for_first_rule = max(longest_match_for_first_rule, longest_match_with_current_rule);
+            const std::vector<SymbolId> &second_rhs = table.Rhs(selected_rules[j]);
+            int minimum_of_two = min(first_rhs.size(), second_rhs.size());
+            int match = std::mismatch(first_rhs.begin(), first_rhs.begin() + minimum_of_two, second_rhs.begin()).first - first_rhs.begin();
+            longest_match[i] = max(longest_match[i], match);
+            longest_match[j] = max(longest_match[j], match);
         }
-        m.longest_match = longest_match_for_first_rule;
-        all_matches.push_back(m);
     }
     /*
     1. A -> A B C D longest_match = 2 // with rule 3
-    2. B -> A B C D longest_match = 1 // with rules 5 and 6
-    3. A -> A B D E longest_match = 2 // with rule 1
+    2. A -> A B D E longest_match = 2 // with rule 1
+    3. A -> B C     longest_match = 0
+    ⍺ comes from the rule with the longest match that is first in
+    lexicographical order (LHS + RHS), here A B from rule 1
     */
-    //Sort by longest match
-    std::sort(all_matches.begin(), all_matches.end(), sortTask4LongestMatch);
-    //Sort lexicographically
-    std::sort(all_matches.begin(), all_matches.end(), sortTask4Lexicographical);
-    /*
-    1. A -> A B C D longest_match = 2 // with rule 3
-    3. A -> A B D E longest_match = 2 // with rule 1
-    2. B -> A B C D longest_match = 1 // with rules 5 and 6
-    */
-
-    // if no rule matches
-    int longest_match = all_matches[0].longest_match;
-    if (longest_match == 0)
+    int best = -1;
+    for (int i = 0; i < (int)selected_rules.size(); i++)
     {
-        for (int i = 0; i < all_matches.size(); i++)
-            uncommon_group.push_back(all_matches[i].rule);
+        if (best < 0 || longest_match[i] > longest_match[best] ||
+            (longest_match[i] == longest_match[best] && table.Less(selected_rules[i], selected_rules[best])))
+            best = i;
+    }
 
-        common_group = {};
+    // if no rule matches
+    if (best < 0 || longest_match[best] == 0)
         return;
-    }
 
-    // If atleast 1 match is present, split the rules into 2 groups
-    std::vector<std::string> longest_prefix = task4ExtractPrefixOfSize(all_matches[0].rule, longest_match);
-    suffix = longest_prefix;
-    common_group.push_back(all_matches[0].rule);
-    for (int i = 1; i < all_matches.size(); i++)
+    // If atleast 1 match is present, the common group is all rules that begin with ⍺
+    const std::vector<SymbolId> &best_rhs = table.Rhs(selected_rules[best]);
+    prefix.assign(best_rhs.begin(), best_rhs.begin() + longest_match[best]);
+    for (ProductionId production : selected_rules)
     {
-        std::vector<std::string> current_prefix = task4ExtractPrefixOfSize(all_matches[i].rule, longest_match);
-        if (longest_prefix == current_prefix)
-            //All rules that begin with ⍺
-            common_group.push_back(all_matches[i].rule);
-        else
-            //All rules that do not begin with ⍺
-            uncommon_group.push_back(all_matches[i].rule);
+        if (task4HasPrefix(table.Rhs(production), prefix))
+            common_group.push_back(production);
     }
 }
 
 // Task 4
-void Task4(CharacterType c, std::vector<Rule> rules)
+void Task4(const CharacterType &c, const std::vector<Rule> &grammar_rules, std::ostream &out, OutputFormat format, Task4Origins *origins)
 {
-    std::vector<std::string> new_non_terminals;
-    std::vector<Rule> new_rules;
-    std::vector<std::string> non_terminals = c.non_terminals;
-    unordered_map<std::string, int> counter_values;
-
-    for (auto nt : non_terminals)
-        counter_values[nt] = 1;
+    // Rules are production ids from here on, so that checking for a
+    // duplicate is a lookup and copies are integers
+    ProductionTable table;
+    std::vector<ProductionId> rules;
+    std::vector<bool> in_rules;
+    ProductionList new_rules;
+    std::vector<SymbolId> non_terminals;
+    for (const auto &nt : c.non_terminals)
+        non_terminals.push_back(table.Symbol(nt));
+    for (const auto &rule : grammar_rules)
+        rules.push_back(table.Add(rule));
+    in_rules.assign(table.Size(), true);
+
+    // Only non terminals of the input get new names
+    std::vector<int> counter_values(table.Symbols(), 1);
 
     while (non_terminals.size())
     {
-        int i = 0;
+        size_t i = 0;
         while (i < non_terminals.size())
         {
-            std::vector<Rule> common, uncommon;
-            std::vector<std::string> suffix;
-            std::string selected_non_terminal = non_terminals[i];
-            task4SplitRules(selected_non_terminal, rules, common, uncommon, suffix);
+            std::vector<ProductionId> common;
+            std::vector<SymbolId> prefix;
+            SymbolId selected_non_terminal = non_terminals[i];
+            task4SplitRules(table, selected_non_terminal, rules, common, prefix);
             if (common.size() >= 2)
             {
                 // remove common rules
-                for (int k = 0; k < common.size(); k++)
-                {
-                    removeFromRules(rules, common[k]);
-                }
+                removeFromRules(rules, in_rules, common);
+                stats.rules_removed += common.size();
 
                 // add the rule A -> ⍺Anew to R
-                std::string new_name = selected_non_terminal + to_string(counter_values[selected_non_terminal]++);
-                std::vector<std::string> new_rhs = suffix;
-                new_rhs.push_back(new_name);
-                Rule r;
-                r.lhs = selected_non_terminal;
-                r.rhs = new_rhs;
-                addToRules(rules, r);
+                std::string new_name = table.Name(selected_non_terminal) + to_string(counter_values[selected_non_terminal]++);
+                SymbolId new_non_terminal = table.Symbol(new_name);
+                if (origins)
+                    (*origins)[new_name] = table.Name(selected_non_terminal);
+                std::vector<SymbolId> rhs = prefix;
+                rhs.push_back(new_non_terminal);
+                addToRules(rules, in_rules, table.Add(selected_non_terminal, std::move(rhs)));
+                stats.rules_created++;
 
                 // add the rule Anew -> β to R'
-                for (int k = 0; k < common.size(); k++)
+                for (ProductionId production : common)
                 {
-                    Rule r;
-                    r.lhs = new_name;
-                    std::vector<std::string>::const_iterator first = common[k].rhs.begin() + suffix.size();
-                    std::vector<std::string>::const_iterator last = common[k].rhs.end();
-                    std::vector<std::string> beta(first, last);
-                    r.rhs = beta;
-                    addToRules(new_rules, r);
+                    // β is what follows ⍺ in the common rule
+                    const std::vector<SymbolId> &common_rhs = table.Rhs(production);
+                    std::vector<SymbolId> beta(common_rhs.begin() + prefix.size(), common_rhs.end());
+                    new_rules.Add(table.Add(new_non_terminal, std::move(beta)));
                 }
-
-                // add Anew to NT'
-                new_non_terminals.push_back(new_name);
+                stats.rules_created += common.size();
                 i++;
             }
             else
             {
                 //If there are no 2 non empty prefix rules
-                int j = 0;
-                while (j < rules.size())
+                for (ProductionId production : rules)
                 {
-                    if (rules[j].lhs == selected_non_terminal)
-                    {
-                        //Add the rule to new rules
-                        addToRules(new_rules, rules[j]);
-                        //Remove the rule from old rules
-                        removeFromRules(rules, rules[j]);
-                    }
-                    else
-                        j++;
+                    //Add the rule to new rules
+                    if (table.Lhs(production) == selected_non_terminal)
+                        new_rules.Add(production);
                 }
+                //Remove the rules from old rules
+                auto last = std::remove_if(rules.begin(), rules.end(), [&](ProductionId production)
+                                           {
+                                               if (table.Lhs(production) != selected_non_terminal)
+                                                   return false;
+                                               in_rules[production] = false;
+                                               return true;
+                                           });
+                rules.erase(last, rules.end());
                 //Remove the non terminal from old non terminals
                 auto it = std::find(non_terminals.begin(), non_terminals.end(), selected_non_terminal);
                 non_terminals.erase(it);
-                //Add the non terminal to new non terminals
-                new_non_terminals.push_back(selected_non_terminal);
             }
         }
     }
 
     //Sort lexicographically
-    std::sort(new_rules.begin(), new_rules.end(), sortRulesComparator);
-    task4PrintRules(new_rules);
+    std::vector<ProductionId> sorted_rules = new_rules.Ids();
+    table.Sort(sorted_rules);
+    if (format != OUTPUT_TEXT)
+        writeStructuredRules(out, format, 4, c, table, sorted_rules);
+    else
+        task4PrintRules(table, sorted_rules, out);
 }
 
 struct Task5Rules
 //Structure to group all rules of a particular non-terminal together
 {
-    std::string lhs;
-    std::vector<Rule> rhs;
+    SymbolId lhs;
+    std::vector<ProductionId> rhs;
 };
 
-std::vector<Rule> sortForTask5(std::vector<Task5Rules> rules)
+std::vector<ProductionId> sortForTask5(const ProductionTable &table, const std::vector<Task5Rules> &rules)
+// Function that returns all inner rules sorted lexicographically (LHS + RHS)
 {
-    // Sort the outer vector lexicographically based on 'lhs'
-    std::sort(rules.begin(), rules.end(),
-              [](Task5Rules &a, Task5Rules &b)
-              {
-                  return a.lhs < b.lhs;
-              });
-
-    std::vector<Rule> inner_rule;
-    // Sort the inner Rule vectors lexicographically based on 'lhs'
-    for (Task5Rules &task5Rule : rules)
-    {
-        for (auto x : task5Rule.rhs)
-            inner_rule.push_back(x);
-    }
+    std::vector<ProductionId> inner_rule;
+    for (const Task5Rules &task5Rule : rules)
+        inner_rule.insert(inner_rule.end(), task5Rule.rhs.begin(), task5Rule.rhs.end());
 
-    std::sort(inner_rule.begin(), inner_rule.end(), sortRulesComparator);
+    table.Sort(inner_rule);
     return inner_rule;
 }
 
-void printTask5Rules(std::vector<Task5Rules> &rules)
+void writeTask5Rules(OutputWriter &output, const ProductionTable &table, const std::vector<ProductionId> &rules)
+// Function that writes sorted rules as Task5 prints them
 {
-    std::vector<Rule> inner_rule = sortForTask5(rules);
-
-    for (auto rule : inner_rule)
+    for (ProductionId rule : rules)
     {
-        std::cout << rule.lhs << " -> ";
+        output << table.Name(table.Lhs(rule)) << " -> ";
 
-        for (std::string &rhs : rule.rhs)
+        for (SymbolId symbol : table.Rhs(rule))
         {
+            const std::string &rhs = table.Name(symbol);
             if (rhs != "#")
-                std::cout << rhs << " ";
+                output << rhs << ' ';
         }
-        cout << "# ";
-        cout << endl;
+        output << "# \n";
+    }
+}
+
+void printTask5Rules(const CharacterType &c, const ProductionTable &table, const std::vector<Task5Rules> &rules, std::ostream &out, OutputFormat format)
+{
+    std::vector<ProductionId> inner_rule = sortForTask5(table, rules);
+    if (format != OUTPUT_TEXT)
+    {
+        writeStructuredRules(out, format, 5, c, table, inner_rule);
+        return;
     }
+    OutputWriter output(out);
+    writeTask5Rules(output, table, inner_rule);
 }
 
+class Task5Stream
+// Task5 with a budget. After step i a rule of a non terminal named below
+// every non terminal still to come is final: later steps only change those
+// and add new ones named after them, and the output is sorted by name. So
+// such rules are printed at once, and freed once the last non terminal
+// that can substitute them (see lastSubstitution) is done.
+{
+  public:
+    Task5Stream(const Task5Budget &budget, ProductionTable &table, std::vector<Task5Rules> &Rules,
+                const std::vector<SymbolId> &order, std::ostream &out)
+        : budget(budget), table(table), Rules(Rules), output(out), free_after(order.size()), printed(0),
+          peak_rules(0), peak_bytes(0)
+    {
+        Task5Groups groups;
+        for (const Task5Rules &group : Rules)
+            groups.push_back(group.rhs);
+        last_substitution = lastSubstitution(table, groups, order);
+        // later_min[i] has the smallest name among order[i..], -1 at the end
+        later_min.resize(order.size() + 1, -1);
+        for (size_t i = order.size(); i-- > 0;)
+        {
+            SymbolId next = later_min[i + 1];
+            later_min[i] = next >= 0 && table.Name(next) < table.Name(order[i]) ? next : order[i];
+        }
+        for (const Task5Rules &group : Rules)
+        {
+            pending[table.Name(group.lhs)] = group.lhs;
+            group_indices[group.lhs].push_back(group.lhs);
+            occurrences[group.lhs] = 1;
+        }
+    }
+
+    // A new non terminal was appended to NT', with its groups from first
+    // on in Rules
+    void AddNonTerminal(SymbolId symbol, size_t first)
+    {
+        pending[table.Name(symbol)] = symbol;
+        occurrences[symbol]++;
+        for (size_t index = first; index < Rules.size(); index++)
+            group_indices[symbol].push_back(index);
+    }
+
+    // Prints and frees what step i made final
+    void StepDone(int i)
+    {
+        SymbolId boundary = later_min[i + 1];
+        std::vector<ProductionId> batch;
+        std::vector<SymbolId> done;
+        while (!pending.empty() && (boundary < 0 || pending.begin()->first < table.Name(boundary)))
+        {
+            SymbolId symbol = pending.begin()->second;
+            pending.erase(pending.begin());
+            // Every group is printed once per occurrence of its LHS in NT'
+            for (int index : group_indices[symbol])
+            {
+                for (int k = 0; k < occurrences[symbol]; k++)
+                    batch.insert(batch.end(), Rules[index].rhs.begin(), Rules[index].rhs.end());
+            }
+            if (symbol < (SymbolId)last_substitution.size() && last_substitution[symbol] > i)
+                free_after[last_substitution[symbol]].push_back(symbol);
+            else
+                done.push_back(symbol);
+        }
+        std::sort(batch.begin(), batch.end(), [this](ProductionId a, ProductionId b)
+                  { return table.Less(a, b); });
+        writeTask5Rules(output, table, batch);
+        printed += batch.size();
+
+        done.insert(done.end(), free_after[i].begin(), free_after[i].end());
+        for (SymbolId symbol : done)
+        {
+            for (int index : group_indices[symbol])
+            {
+                for (ProductionId production : Rules[index].rhs)
+                    table.Release(production);
+                std::vector<ProductionId>().swap(Rules[index].rhs);
+            }
+            group_indices.erase(symbol);
+        }
+    }
+
+    // Checks the budget and keeps the peak
+    bool OverBudget()
+    {
+        long rules = table.Live();
+        long long bytes = table.MemoryBytes();
+        peak_rules = std::max(peak_rules, rules);
+        peak_bytes = std::max(peak_bytes, bytes);
+        return (budget.max_rules > 0 && rules > budget.max_rules) || (budget.max_bytes > 0 && bytes > budget.max_bytes);
+    }
+
+    void Report(Task5Report &report) const
+    {
+        report.rules = printed;
+        report.held_rules = table.Live();
+        report.held_bytes = table.MemoryBytes();
+        report.peak_rules = peak_rules;
+        report.peak_bytes = peak_bytes;
+    }
+
+  private:
+    const Task5Budget &budget;
+    ProductionTable &table;
+    std::vector<Task5Rules> &Rules;
+    OutputWriter output;
+    std::vector<int> last_substitution;
+    std::vector<SymbolId> later_min;
+    // Non terminals not printed yet, by name
+    std::map<std::string, SymbolId> pending;
+    // Indices in Rules of the groups of each non terminal not freed yet
+    std::unordered_map<SymbolId, std::vector<int>> group_indices;
+    std::unordered_map<SymbolId, int> occurrences;
+    // Printed non terminals to free after step i
+    std::vector<std::vector<SymbolId>> free_after;
+    long printed;
+    long peak_rules;
+    long long peak_bytes;
+};
+
 // Task 5
-void Task5(CharacterType c, std::vector<Rule> rule)
+// Returns 1 if the grammar has epsilon rules (they are printed as they are),
+// 2 if it stopped at the budget
+int Task5(const CharacterType &c, const std::vector<Rule> &rule, std::ostream &out, OutputFormat format, Task5Order order, Task5Report *report,
+          const Task5Budget *budget)
 {
+    // Rules are production ids (see productions.h), copying a group copies integers
+    ProductionTable table;
     std::vector<Task5Rules> Rules;
-    std::vector<std::string> non_terminals;
-    non_terminals = c.non_terminals;
     std::vector<Task5Rules> Rules_1;
-    for (std::string nt : non_terminals)
+    // The non terminals are the first symbols, so Rules[symbol] is the group of symbol
+    for (const std::string &nt : c.non_terminals)
     {
         Task5Rules r;
-        r.lhs = nt;
+        r.lhs = table.Symbol(nt);
         r.rhs = {};
-        Rules.push_back(r);
+        Rules.push_back(std::move(r));
     }
     bool epsilon_found = false;
-    for (Task5Rules &task5rule : Rules)
+    for (const Rule &r : rule)
     {
-        for (Rule r : rule)
+        if (r.rhs[0] == "#")
         {
-            if (r.rhs[0] == "#")
-            {
-                epsilon_found = true;
-            }
-            if (task5rule.lhs == r.lhs)
-            {
-                task5rule.rhs.push_back(r);
-            }
+            epsilon_found = true;
         }
+        ProductionId production = table.Add(r);
+        Rules[table.Lhs(production)].rhs.push_back(production);
     }
     if (epsilon_found)
     {
-        printTask5Rules(Rules);
-        exit(1);
+        if (report)
+            report->predicted_rules = report->rules = rule.size();
+        printTask5Rules(c, table, Rules, out, format);
+        return 1;
     }
 
-    // NT' = NT sorted lexicographically (dictionary order)
-    std::vector<std::string> new_non_terminals = non_terminals;
-    std::sort(new_non_terminals.begin(), new_non_terminals.end());
-    unordered_map<std::string, int> counter_values;
-    for (auto nt : new_non_terminals)
+    std::vector<SymbolId> new_non_terminals;
+    Task5Groups groups;
+    if (order == TASK5_ORDER_DEPENDENCY || report)
+    {
+        for (const Task5Rules &group : Rules)
+            groups.push_back(group.rhs);
+    }
+    if (order == TASK5_ORDER_DEPENDENCY)
+    {
+        // NT' = NT in the order of the left corner graph (see task5order.h)
+        double predicted_rules;
+        new_non_terminals = dependencyOrder(table, groups, predicted_rules);
+        if (report)
+            report->predicted_rules = predicted_rules;
+    }
+    else
+    {
+        // NT' = NT sorted lexicographically (dictionary order)
+        for (const Task5Rules &group : Rules)
+            new_non_terminals.push_back(group.lhs);
+        std::sort(new_non_terminals.begin(), new_non_terminals.end(), [&table](SymbolId a, SymbolId b)
+                  { return table.Name(a) < table.Name(b); });
+        if (report)
+            report->predicted_rules = predictTask5Rules(table, groups, new_non_terminals);
+    }
+    unordered_map<SymbolId, int> counter_values;
+    for (const auto &nt : new_non_terminals)
         counter_values[nt] = 1;
     int n = new_non_terminals.size();
+    std::unique_ptr<Task5Stream> stream;
+    if (budget && (budget->max_rules > 0 || budget->max_bytes > 0))
+        stream.reset(new Task5Stream(*budget, table, Rules, new_non_terminals, out));
+    // Stops at the budget with what was printed so far
+    auto overBudget = [&](int done)
+    {
+        if (!stream->OverBudget())
+            return false;
+        if (report)
+        {
+            stream->Report(*report);
+            report->over_budget = true;
+            report->non_terminals_done = done;
+            report->non_terminals = n;
+        }
+        return true;
+    };
     for (int i = 0; i < n; i++)
     {
         int index_i;
@@ -952,15 +1255,15 @@ void Task5(CharacterType c, std::vector<Rule> rule)
             {
 
                 int index_j;
-                std::vector<std::string> delta;
+                ProductionId r = Rules[index_i].rhs[k];
                 // if r has the form Rules[Ai].rhs -> Aj⍺ where Aj < Ai then
-                if (Rules[index_i].rhs[k].lhs == new_non_terminals[i] && Rules[index_i].rhs[k].rhs[0] == new_non_terminals[j])
+                if (table.Lhs(r) == new_non_terminals[i] && table.Rhs(r)[0] == new_non_terminals[j])
                 {
                     // Store the remaining part of the rule except the first Character of RHS
-                    for (int kx = 1; kx < Rules[index_i].rhs[k].rhs.size(); kx++)
-                        delta.push_back(Rules[index_i].rhs[k].rhs[kx]);
+                    std::vector<SymbolId> delta(table.Rhs(r).begin() + 1, table.Rhs(r).end());
                     // Remove the Rule r from
                     Rules[index_i].rhs.erase(Rules[index_i].rhs.begin() + k);
+                    stats.rules_removed++;
                     // select Aj
                     for (index_j = 0; index_j < Rules.size(); index_j++)
                     {
@@ -971,15 +1274,17 @@ void Task5(CharacterType c, std::vector<Rule> rule)
                     }
                     for (int kx = 0; kx < Rules[index_j].rhs.size(); kx++)
                     {
-                        std::vector<std::string> new_rule;
-                        Rule rul;
-                        new_rule = Rules[index_j].rhs[kx].rhs;
-                        new_rule.insert(new_rule.end(), delta.begin(), delta.end());
-
-                        rul.lhs = Rules[index_i].lhs;
-                        rul.rhs = new_rule; // concatenate
-                        Rules[index_i].rhs.push_back(rul);
+                        // gamma is not used after Add, which may move it
+                        const std::vector<SymbolId> &gamma = table.Rhs(Rules[index_j].rhs[kx]);
+                        std::vector<SymbolId> rhs;
+                        rhs.reserve(gamma.size() + delta.size());
+                        rhs.insert(rhs.end(), gamma.begin(), gamma.end()); // concatenate
+                        rhs.insert(rhs.end(), delta.begin(), delta.end());
+                        Rules[index_i].rhs.push_back(table.Add(Rules[index_i].lhs, std::move(rhs)));
                     }
+                    stats.rules_created += Rules[index_j].rhs.size();
+                    if (stream && overBudget(i))
+                        return 2;
                 }
                 else
                     k++;
@@ -998,16 +1303,14 @@ void Task5(CharacterType c, std::vector<Rule> rule)
         // S -> S B C G H I F G H E F E F D E B C D *
         // S -> d E F E F D E B C D *
         // S -> c E F D E B C D *
-        std::string new_rule_lhs;
-        int k = 0;
-        std::vector<Rule> left_recur, no_left_recur;
-        for (int k = 0; k < Rules[index_i].rhs.size(); k++) // remove
+        std::vector<ProductionId> left_recur, no_left_recur;
+        for (ProductionId r : Rules[index_i].rhs) // remove
         {
 
-            if (Rules[index_i].rhs[k].lhs == Rules[index_i].rhs[k].rhs[0])
+            if (table.Lhs(r) == table.Rhs(r)[0])
             {
 
-                left_recur.push_back(Rules[index_i].rhs[k]);
+                left_recur.push_back(r);
                 // S -> S A b c G H I F G H E F E F D E B C D *
                 // S -> S B C G H I F G H E F E F D E B C D *
             }
@@ -1016,127 +1319,178 @@ void Task5(CharacterType c, std::vector<Rule> rule)
                 // S -> d E F E F D E B C D *
                 // S -> c E F D E B C D *
 
-                no_left_recur.push_back(Rules[index_i].rhs[k]);
+                no_left_recur.push_back(r);
             }
         }
 
         if (left_recur.size())
         {
+            SymbolId lhs = Rules[index_i].lhs;
             Rules[index_i].rhs = {};
-            new_rule_lhs = left_recur[k].lhs + to_string(counter_values[left_recur[k].lhs]++); // S1
+            stats.rules_removed += left_recur.size() + no_left_recur.size();
+            stats.rules_created += left_recur.size() + no_left_recur.size();
+            SymbolId new_rule_lhs = table.Symbol(table.Name(lhs) + to_string(counter_values[lhs]++)); // S1
             new_non_terminals.push_back(new_rule_lhs);
+            counter_values[new_rule_lhs] = 1;
+            size_t first_group = Rules.size();
 
-            for (int k = 0; k < left_recur.size(); k++)
+            for (ProductionId r : left_recur)
             {
 
                 // Add new terminal to Rule
-                Rule r;
-                counter_values[new_rule_lhs] = 1;
                 Task5Rules R;
-                R.lhs = new_rule_lhs;                                                                    // outer S1
-                r.lhs = new_rule_lhs;                                                                    // inner S1
-                std::vector<std::string> suffix(left_recur[k].rhs.begin() + 1, left_recur[k].rhs.end()); // A b c G H I F G H E F E F D E B C D
-                suffix.push_back(new_rule_lhs);                                                          // A b c G H I F G H E F E F D E B C D S1
-                r.rhs = suffix;
-                R.rhs.push_back(r);
-                Rules.push_back(R);
-
-                // Remove from vector
-
-                // Extract remaining
-                // Append to end of each other vector
+                R.lhs = new_rule_lhs;                                                            // outer S1
+                std::vector<SymbolId> suffix(table.Rhs(r).begin() + 1, table.Rhs(r).end()); // A b c G H I F G H E F E F D E B C D
+                suffix.push_back(new_rule_lhs);                                                  // A b c G H I F G H E F E F D E B C D S1
+                R.rhs.push_back(table.Add(new_rule_lhs, std::move(suffix)));                     // inner S1
+                Rules.push_back(std::move(R));
             }
-            if (no_left_recur.size())
+            for (ProductionId r : no_left_recur)
             {
-                for (int k = 0; k < no_left_recur.size(); k++)
-                {
-
-                    // Add new terminal to Rule
-                    Rule r;
-                    r.lhs = Rules[index_i].lhs;                   // inner S1
-                    no_left_recur[k].rhs.push_back(new_rule_lhs); // S -> d E F E F D E B C D S1 * // S -> c E F D E B C D S1 *
-                    r.rhs = no_left_recur[k].rhs;
-                    Rules[index_i].rhs.push_back(r);
-                }
+                // Add new terminal to Rule
+                std::vector<SymbolId> rhs = table.Rhs(r);
+                rhs.push_back(new_rule_lhs); // S -> d E F E F D E B C D S1 * // S -> c E F D E B C D S1 *
+                Rules[index_i].rhs.push_back(table.Add(lhs, std::move(rhs)));
             }
+            if (stream)
+                stream->AddNonTerminal(new_rule_lhs, first_group);
+        }
+        else
+        {
+            // Nothing to remove, put the rules back in their original order
+            Rules[index_i].rhs = std::move(no_left_recur);
+        }
+        if (stream)
+        {
+            if (overBudget(i))
+                return 2;
+            stream->StepDone(i);
         }
     }
-
-    Rules_1 = {};
-    std::sort(new_non_terminals.begin(), new_non_terminals.end());
-
-    for (int k = 0; k < new_non_terminals.size(); k++)
+    if (stream)
     {
-        std::string selected_NT = new_non_terminals[k];
-
-        for (int m = 0; m < Rules.size(); m++)
+        if (report)
         {
-            if (Rules[m].lhs == selected_NT)
-            {
-                Rules_1.push_back(Rules[m]);
-            }
+            stream->Report(*report);
+            report->non_terminals_done = report->non_terminals = n;
         }
+        return 0;
     }
-    printTask5Rules(Rules_1);
-}
-int main(int argc, char *argv[])
-{
-    int task;
 
-    if (argc < 2)
+    // Every group is printed once per occurrence of its LHS in NT'. The
+    // order does not matter here, printTask5Rules sorts all the rules
+    unordered_map<SymbolId, int> occurrences;
+    for (const auto &nt : new_non_terminals)
+        occurrences[nt]++;
+
+    Rules_1 = {};
+    for (int m = 0; m < Rules.size(); m++)
     {
-        cout << "Error: missing argument\n";
-        return 1;
+        int count = occurrences[Rules[m].lhs];
+        for (int k = 1; k < count; k++)
+            Rules_1.push_back(Rules[m]);
+        if (count)
+            Rules_1.push_back(std::move(Rules[m]));
     }
+    if (report)
+    {
+        report->rules = 0;
+        for (const Task5Rules &group : Rules_1)
+            report->rules += group.rhs.size();
+    }
+    printTask5Rules(c, table, Rules_1, out, format);
+    return 0;
+}
 
-    /*
-       Note that by convention argv[0] is the name of your executable,
-       and the first argument to your program is stored in argv[1]
-     */
+// Task 6
+void Task6(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out)
+{
+    Fsets first_sets;
+    findFirstSets(c, rules, first_sets);
+    Fsets follow_sets;
+    findFollowSets(c, rules, first_sets, follow_sets);
+    Task6(c, rules, follow_sets, out);
+}
 
-    task = atoi(argv[1]);
-    std::vector<Rule> rules;
-    readGrammar(rules); // Reads the input grammar from standard input
-                        // and represent it internally in data structures
-                        // ad described in project 2 presentation file
+void Task6(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &follow_sets, std::ostream &out)
+{
+    LRAutomaton automaton(c, rules);
+    std::vector<LRConflict> conflicts = findConflicts(automaton, slrLookaheads(automaton, follow_sets));
+
+    out << "LR(0) states: " << automaton.StateCount() << "\n";
+    out << "LR(0) kernel items: " << automaton.KernelItemCount() << "\n";
+    out << "LR(0) closure items: " << automaton.ClosureItemCount() << "\n";
+    printConflicts(out, "SLR(1)", automaton, conflicts);
+    LalrRelations relations;
+    conflicts = findConflicts(automaton, lalrLookaheads(automaton, &relations));
+    out << "LALR(1) relations: " << relations.transitions << " transitions, " << relations.reads << " reads, "
+        << relations.includes << " includes, " << relations.lookback << " lookback\n";
+    printConflicts(out, "LALR(1)", automaton, conflicts);
+}
 
-    switch (task)
-    {
-    case 1:
-        Task1(rules);
-        break;
+// Task 7
+void Task7(const CharacterType &c, const std::vector<Rule> &rules, const Sentences &sentences, std::ostream &out)
+{
+    Fsets first_sets;
+    findFirstSets(c, rules, first_sets);
+    Task7(c, rules, FirstOfTable(rules, first_sets), sentences, out);
+}
 
-    case 2:
-    {
-        CharacterType c = fetchTypes(rules);
-        Task2(c, rules);
-        break;
-    }
+void Task7(const CharacterType &c, const std::vector<Rule> &rules, const FirstOfTable &suffixes, const Sentences &sentences, std::ostream &out)
+{
+    EarleyRecognizer recognizer(c, rules, suffixes);
 
-    case 3:
-    {
-        CharacterType c = fetchTypes(rules);
-        Task3(c, rules);
-        break;
-    }
+    OutputWriter output(out);
+    for (const auto &sentence : sentences)
+        output << (recognizer.Recognize(sentence) ? "ACCEPTED\n" : "REJECTED\n");
+}
 
-    case 4:
-    {
-        CharacterType c = fetchTypes(rules);
-        Task4(c, rules);
-        break;
-    }
+// Task 8
+void Task8(const CharacterType &c, const std::vector<Rule> &rules, const Sentences &sentences, int threads, std::ostream &out)
+{
+    CykRecognizer recognizer(toCnf(c, rules));
+    std::vector<bool> accepted = recognizeSentences(recognizer, sentences, threads);
+
+    OutputWriter output(out);
+    for (bool sentence_accepted : accepted)
+        output << (sentence_accepted ? "ACCEPTED\n" : "REJECTED\n");
+}
 
-    case 5:
+// Task 9
+void Task9(const CharacterType &c, const std::vector<Rule> &rules, int max_k, std::ostream &out)
+{
+    std::vector<LLkResult> results = findLLk(c, rules, max_k);
+    if (results.empty() && !c.non_terminals.empty())
     {
-        CharacterType c = fetchTypes(rules);
-        Task5(c, rules);
-        break;
+        out << "LL(k): too many terminals\n";
+        return;
     }
-
-    default:
-        cout << "Error: unrecognized task number " << task << "\n";
-        break;
+    OutputWriter output(out);
+    int grammar_k = 0;
+    bool decided = true, conflict_free = true;
+    for (size_t n = 0; n < results.size(); n++)
+    {
+        output << c.non_terminals[n] << ": ";
+        if (results[n].k > 0)
+        {
+            output << "LL(" << (long long)results[n].k << ")\n";
+            grammar_k = std::max(grammar_k, results[n].k);
+        }
+        else if (results[n].undecided_at > 0)
+        {
+            output << "undecided, sets too large at k = " << (long long)results[n].undecided_at << "\n";
+            decided = false;
+        }
+        else
+        {
+            output << "not LL(" << (long long)max_k << ")\n";
+            conflict_free = false;
+        }
     }
-    return 0;
+    if (!conflict_free)
+        output << "grammar: not LL(" << (long long)max_k << ")\n";
+    else if (!decided)
+        output << "grammar: undecided\n";
+    else
+        output << "grammar: LL(" << (long long)std::max(grammar_k, 1) << ")\n";
 }
@@ -0,0 +1,119 @@
+/*
+ * Modified by Aditya Ranjit Kotwal, 2023
+ */
+
+/*
+ * Copyright (C) Mohsen Zohrevandi, 2017
+ *               Rida Bazzi 2019
+ * Do not share this file with anyone
+ */
+#ifndef __PROJECT2__H__
+#define __PROJECT2__H__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "lexer.h"
+#include "output.h"
+#include "sentences.h"
+
+struct CharacterType
+// Structure to store terminals and non terminals
+{
+    std::vector<std::string> non_terminals;
+    std::vector<std::string> terminals;
+};
+
+struct Rule
+// Structure to define a Rule LHS -> RHS
+{
+    std::string lhs;
+    std::vector<std::string> rhs;
+};
+
+typedef std::unordered_map<std::string, std::vector<std::string>> Fsets;
+
+typedef enum {
+    TASK5_ORDER_LEXICOGRAPHIC = 0,
+    TASK5_ORDER_DEPENDENCY // see task5order.h
+} Task5Order;
+
+struct Task5Report
+// Size of the Task5 output, as predicted from the chosen order and as printed
+{
+    double predicted_rules = 0;
+    long rules = 0;
+    // With a budget: whether Task5 stopped at it, after how many of the non
+    // terminals, and the productions held when it ended and at most
+    bool over_budget = false;
+    long non_terminals_done = 0;
+    long non_terminals = 0;
+    long held_rules = 0;
+    long long held_bytes = 0;
+    long peak_rules = 0;
+    long long peak_bytes = 0;
+};
+
+// The input non terminal each name Task4 made was made from (A11 can be
+// made from A or from A1)
+typedef std::unordered_map<std::string, std::string> Task4Origins;
+
+struct Task5Budget
+// Limits on the productions Task5 holds at a time, 0 for none. With either
+// limit set, Task5 prints rules as soon as they are final and frees them
+{
+    long max_rules = 0;
+    long long max_bytes = 0;
+};
+
+// None of these functions use global state, so they can be used from
+// several threads on different grammars (see GrammarContext)
+
+// Returns false on a syntax error
+bool readGrammar(LexicalAnalyzer &lexer, std::vector<Rule> &rules);
+CharacterType fetchTypes(const std::vector<Rule> &rules);
+void findFirstSets(const CharacterType &c, const std::vector<Rule> &rules, Fsets &FirstSet);
+void findFollowSets(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, Fsets &FollowSet);
+// Same, reusing suffix FIRST sets built from rules and FirstSet (see firstof.h)
+class FirstOfTable;
+void findFollowSets(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &FirstSet, const FirstOfTable &suffixes, Fsets &FollowSet);
+
+// Put one FIRST or FOLLOW set in the order Task2 or Task3 prints it
+void sortFirstSet(std::vector<std::string> &set, const CharacterType &c);
+void sortFollowSet(std::vector<std::string> &set, const CharacterType &c);
+// Prints one line of Task2 or Task3, NAME(X) = { ... }
+void printSet(OutputWriter &output, const char *name, const std::string &symbol, const std::vector<std::string> &set);
+
+// Task1 to Task5 write JSON or binary instead of text with another format
+// (see structured.h)
+void Task1(const std::vector<Rule> &rules, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT);
+void Task2(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT);
+void Task3(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT);
+// Same, from FIRST or FOLLOW sets computed before (see GrammarContext),
+// which are not changed
+void Task2(const CharacterType &c, const Fsets &first_sets, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT);
+void Task3(const CharacterType &c, const Fsets &follow_sets, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT);
+// origins, if given, gets the non terminal each new name was made from
+void Task4(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT,
+           Task4Origins *origins = nullptr);
+// Returns 1 if the grammar has epsilon rules, 0 otherwise. order picks
+// the order non terminals are eliminated in, report gets the output size.
+// With a budget the output is text, and Task5 returns 2 if the budget is
+// exceeded; the rules printed until then are the start of the full output
+int Task5(const CharacterType &c, const std::vector<Rule> &rule, std::ostream &out = std::cout, OutputFormat format = OUTPUT_TEXT,
+          Task5Order order = TASK5_ORDER_LEXICOGRAPHIC, Task5Report *report = nullptr, const Task5Budget *budget = nullptr);
+// LR(0) automaton size and SLR(1) and LALR(1) conflicts
+void Task6(const CharacterType &c, const std::vector<Rule> &rules, std::ostream &out = std::cout);
+void Task6(const CharacterType &c, const std::vector<Rule> &rules, const Fsets &follow_sets, std::ostream &out = std::cout);
+// Earley recognition, one ACCEPTED or REJECTED line per sentence
+void Task7(const CharacterType &c, const std::vector<Rule> &rules, const Sentences &sentences, std::ostream &out = std::cout);
+void Task7(const CharacterType &c, const std::vector<Rule> &rules, const FirstOfTable &suffixes, const Sentences &sentences, std::ostream &out = std::cout);
+// CYK recognition of the grammar in Chomsky Normal Form, same output as
+// Task7; the sentences are split between threads (<= 0 for every core)
+void Task8(const CharacterType &c, const std::vector<Rule> &rules, const Sentences &sentences, int threads, std::ostream &out = std::cout);
+// Smallest k up to max_k for which each non terminal is LL(k) (see llk.h)
+void Task9(const CharacterType &c, const std::vector<Rule> &rules, int max_k, std::ostream &out = std::cout);
+
+#endif //__PROJECT2__H__
@@ -0,0 +1,172 @@
+/*
+ * Removal of useless symbols.
+ */
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "reduce.h"
+
+using namespace std;
+
+static long countSymbols(const vector<Rule> &rules, const vector<int> &ids, const vector<bool> &keep, size_t symbol_count)
+// Number of distinct symbols in the kept rules
+{
+    vector<bool> seen(symbol_count, false);
+    long count = 0;
+    size_t next = 0;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        size_t length = 1 + rules[r].rhs.size();
+        if (keep[r])
+        {
+            for (size_t k = next; k < next + length; k++)
+            {
+                if (ids[k] >= 0 && !seen[ids[k]])
+                {
+                    seen[ids[k]] = true;
+                    count++;
+                }
+            }
+        }
+        next += length;
+    }
+    return count;
+}
+
+ReduceReport reduceGrammar(vector<Rule> &rules)
+{
+    ReduceReport report;
+    if (rules.empty())
+        return report;
+
+    // Symbol IDs, flattened as lhs followed by the rhs of every rule; -1 for "#"
+    unordered_map<string, int> symbol_ids;
+    vector<int> ids;
+    vector<bool> is_non_terminal;
+    auto intern = [&](const string &symbol)
+    {
+        auto inserted = symbol_ids.emplace(symbol, (int)is_non_terminal.size());
+        if (inserted.second)
+            is_non_terminal.push_back(false);
+        return inserted.first->second;
+    };
+    for (const Rule &rule : rules)
+    {
+        int lhs = intern(rule.lhs);
+        is_non_terminal[lhs] = true;
+        ids.push_back(lhs);
+        for (const string &symbol : rule.rhs)
+            ids.push_back(symbol == "#" ? -1 : intern(symbol));
+    }
+    size_t symbol_count = is_non_terminal.size();
+    vector<bool> keep(rules.size(), true);
+    long symbols_before = countSymbols(rules, ids, keep, symbol_count);
+
+    // Generating: a rule fires once every non terminal occurrence in its rhs
+    // is known to be generating
+    vector<size_t> rule_start(rules.size());
+    vector<int> pending(rules.size(), 0);
+    vector<vector<int>> occurrences(symbol_count);
+    size_t next = 0;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        rule_start[r] = next;
+        for (size_t k = next + 1; k <= next + rules[r].rhs.size(); k++)
+        {
+            if (ids[k] >= 0 && is_non_terminal[ids[k]])
+            {
+                pending[r]++;
+                occurrences[ids[k]].push_back(r);
+            }
+        }
+        next += 1 + rules[r].rhs.size();
+    }
+
+    vector<bool> generating(symbol_count);
+    for (size_t s = 0; s < symbol_count; s++)
+        generating[s] = !is_non_terminal[s];
+    vector<int> worklist;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        int lhs = ids[rule_start[r]];
+        if (pending[r] == 0 && !generating[lhs])
+        {
+            generating[lhs] = true;
+            worklist.push_back(lhs);
+        }
+    }
+    while (!worklist.empty())
+    {
+        int symbol = worklist.back();
+        worklist.pop_back();
+        for (int r : occurrences[symbol])
+        {
+            int lhs = ids[rule_start[r]];
+            if (--pending[r] == 0 && !generating[lhs])
+            {
+                generating[lhs] = true;
+                worklist.push_back(lhs);
+            }
+        }
+    }
+    for (size_t s = 0; s < symbol_count; s++)
+    {
+        if (!generating[s])
+            report.non_generating++;
+    }
+    for (size_t r = 0; r < rules.size(); r++)
+        keep[r] = pending[r] == 0;
+    long symbols_generating = countSymbols(rules, ids, keep, symbol_count);
+
+    // Reachable from the start symbol through the rules that are left
+    vector<vector<int>> rules_of(symbol_count);
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        if (keep[r])
+            rules_of[ids[rule_start[r]]].push_back(r);
+    }
+    vector<bool> reachable(symbol_count, false);
+    int start = ids[0];
+    reachable[start] = true;
+    worklist.push_back(start);
+    while (!worklist.empty())
+    {
+        int symbol = worklist.back();
+        worklist.pop_back();
+        for (int r : rules_of[symbol])
+        {
+            for (size_t k = rule_start[r] + 1; k <= rule_start[r] + rules[r].rhs.size(); k++)
+            {
+                if (ids[k] >= 0 && !reachable[ids[k]])
+                {
+                    reachable[ids[k]] = true;
+                    worklist.push_back(ids[k]);
+                }
+            }
+        }
+    }
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        if (keep[r] && !reachable[ids[rule_start[r]]])
+            keep[r] = false;
+    }
+    long symbols_after = countSymbols(rules, ids, keep, symbol_count);
+    report.unreachable = symbols_generating - symbols_after;
+    report.symbols_removed = symbols_before - symbols_after;
+
+    size_t kept = 0;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+        if (keep[r])
+        {
+            if (kept != r)
+                rules[kept] = std::move(rules[r]);
+            kept++;
+        }
+    }
+    report.rules_removed = rules.size() - kept;
+    rules.resize(kept);
+    return report;
+}
@@ -0,0 +1,29 @@
+/*
+ * Removal of useless symbols.
+ *
+ * A non terminal is useless if it derives no string of terminals (it is not
+ * generating) or if it cannot be reached from the start symbol, the first
+ * non terminal in order of appearance. reduceGrammar drops every rule that
+ * mentions a non generating symbol and then every rule of an unreachable
+ * non terminal, so the grammar still derives the same language. Both sets
+ * are found with worklists in time linear in the size of the grammar.
+ */
+#ifndef __REDUCE__H__
+#define __REDUCE__H__
+
+#include <vector>
+
+#include "project2.h"
+
+struct ReduceReport
+{
+    long non_generating = 0; // non terminals
+    long unreachable = 0;    // non terminals and terminals left after the first step
+    long symbols_removed = 0;
+    long rules_removed = 0;
+};
+
+// Keeps the remaining rules in their original order
+ReduceReport reduceGrammar(std::vector<Rule> &rules);
+
+#endif //__REDUCE__H__
@@ -0,0 +1,493 @@
+/*
+ * Regression gate: ./a.out regress [options]
+ */
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "grammarcontext.h"
+#include "grammargen.h"
+#include "regress.h"
+#include "stats.h"
+
+using namespace std;
+
+struct RegressGrammar
+{
+    const char *name;
+    GrammarGenParams params;
+};
+
+struct RegressPhase
+{
+    double seconds = -1; // -1 if the phase did not run
+    long long allocations = 0;
+};
+
+struct RegressResult
+{
+    uint64_t hash = 0;
+    RegressPhase phases[STATS_PHASE_COUNT];
+};
+
+class HashBuffer : public streambuf
+// FNV-1a of everything written, so that outputs are compared without
+// keeping them
+{
+  public:
+    uint64_t Hash() const { return hash; }
+
+  protected:
+    int overflow(int c) override
+    {
+        if (c != EOF)
+            Add((char)c);
+        return c;
+    }
+    streamsize xsputn(const char *s, streamsize n) override
+    {
+        for (streamsize i = 0; i < n; i++)
+            Add(s[i]);
+        return n;
+    }
+
+  private:
+    void Add(char c)
+    {
+        hash ^= (unsigned char)c;
+        hash *= 1099511628211ull;
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+};
+
+static vector<RegressGrammar> regressCorpus()
+// Large enough that the phases take milliseconds, small enough that
+// Task5 does not blow up; changing it means writing a new baseline
+{
+    vector<RegressGrammar> corpus(5);
+    corpus[0].name = "wide";
+    corpus[0].params.non_terminals = 400;
+    corpus[0].params.terminals = 80;
+    corpus[0].params.alternatives = 4;
+    corpus[0].params.rhs_length = 6;
+
+    corpus[1].name = "long-rhs";
+    corpus[1].params.seed = 2;
+    corpus[1].params.non_terminals = 100;
+    corpus[1].params.terminals = 20;
+    corpus[1].params.alternatives = 4;
+    corpus[1].params.rhs_length = 32;
+
+    corpus[2].name = "left-recursive";
+    corpus[2].params.seed = 3;
+    corpus[2].params.non_terminals = 100;
+    corpus[2].params.terminals = 20;
+    corpus[2].params.alternatives = 4;
+    corpus[2].params.rhs_length = 6;
+    corpus[2].params.left_recursion_depth = 2;
+
+    corpus[3].name = "shared-prefix";
+    corpus[3].params.seed = 4;
+    corpus[3].params.non_terminals = 200;
+    corpus[3].params.terminals = 20;
+    corpus[3].params.alternatives = 4;
+    corpus[3].params.rhs_length = 8;
+    corpus[3].params.shared_prefix_depth = 2;
+
+    corpus[4].name = "epsilon";
+    corpus[4].params.seed = 5;
+    corpus[4].params.non_terminals = 200;
+    corpus[4].params.terminals = 20;
+    corpus[4].params.alternatives = 4;
+    corpus[4].params.rhs_length = 6;
+    corpus[4].params.epsilon_density = 0.2;
+    return corpus;
+}
+
+static void deriveWords(const string &symbol, const unordered_map<string, vector<const Rule *>> &rules_of, const unordered_map<string, int> &shortest, int depth, GrammarRandom &random, vector<string> &words)
+// Random rules near the start symbol, then the rules that end the sentence
+// soonest
+{
+    auto rules = rules_of.find(symbol);
+    if (rules == rules_of.end())
+    {
+        if (symbol != "#")
+            words.push_back(symbol);
+        return;
+    }
+    vector<const Rule *> usable;
+    const Rule *best = nullptr;
+    int best_length = 0;
+    for (const Rule *rule : rules->second)
+    {
+        int length = 0;
+        for (const string &each_rhs : rule->rhs)
+        {
+            auto found = shortest.find(each_rhs);
+            if (found == shortest.end())
+            {
+                length = -1;
+                break;
+            }
+            length += found->second;
+        }
+        if (length < 0)
+            continue;
+        usable.push_back(rule);
+        if (!best || length < best_length)
+        {
+            best = rule;
+            best_length = length;
+        }
+    }
+    const Rule *rule = depth < 6 && words.size() < 24 ? usable[random.Below(usable.size())] : best;
+    for (const string &each_rhs : rule->rhs)
+        deriveWords(each_rhs, rules_of, shortest, depth + 1, random, words);
+}
+
+static string regressSentences(const GrammarGenParams &params, const string &grammar)
+// Half of the sentences are derived from the start symbol, the other half
+// are words drawn from the terminals; one sentence per line
+{
+    GrammarContext context;
+    context.LoadString(grammar);
+    const CharacterType &c = context.Types();
+    vector<string> terminals;
+    unordered_map<string, int> shortest; // fewest words a symbol derives
+    for (const string &terminal : c.terminals)
+    {
+        shortest[terminal] = terminal != "#";
+        if (terminal != "#")
+            terminals.push_back(terminal);
+    }
+    unordered_map<string, vector<const Rule *>> rules_of;
+    for (const Rule &rule : context.Rules())
+        rules_of[rule.lhs].push_back(&rule);
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (const Rule &rule : context.Rules())
+        {
+            int length = 0;
+            for (const string &each_rhs : rule.rhs)
+            {
+                auto found = shortest.find(each_rhs);
+                length = found == shortest.end() || length < 0 ? -1 : length + found->second;
+            }
+            auto found = shortest.find(rule.lhs);
+            if (length >= 0 && (found == shortest.end() || length < found->second))
+            {
+                shortest[rule.lhs] = length;
+                changed = true;
+            }
+        }
+    }
+
+    GrammarRandom random(params.seed);
+    string sentences;
+    for (int s = 0; s < 20 && !terminals.empty(); s++)
+    {
+        vector<string> words;
+        if (s % 2 == 0 && shortest.count(c.non_terminals[0]))
+            deriveWords(c.non_terminals[0], rules_of, shortest, 0, random, words);
+        else
+        {
+            int length = random.Below(17);
+            for (int w = 0; w < length; w++)
+                words.push_back(terminals[random.Below(terminals.size())]);
+        }
+        for (size_t w = 0; w < words.size(); w++)
+            sentences += (w ? " " : "") + words[w];
+        sentences += "\n";
+    }
+    return sentences;
+}
+
+static void regressRun(const string &grammar, const string &sentences, int task, RegressResult &result)
+{
+    stats = RunStats();
+    HashBuffer hash_buffer;
+    ostream out(&hash_buffer);
+
+    GrammarContext context;
+    context.SetThreads(1);
+    context.LoadString(grammar);
+    istringstream sentence_input(sentences);
+    context.LoadSentences(sentence_input);
+    StatsTimer task_timer(STATS_TASK);
+    context.RunTask(task, out);
+    task_timer.Stop();
+
+    result.hash = hash_buffer.Hash();
+    for (int p = 0; p < STATS_PHASE_COUNT; p++)
+    {
+        if (stats.calls[p] == 0)
+            continue;
+        RegressPhase &phase = result.phases[p];
+        if (phase.seconds < 0 || stats.seconds[p] < phase.seconds)
+            phase.seconds = stats.seconds[p];
+        phase.allocations = stats.allocations[p];
+    }
+}
+
+static vector<string> regressQueries(const string &grammar, int task)
+// Every non terminal asked for alone, last to first so that later queries
+// meet closures solved by earlier ones, must print its line of the task
+{
+    vector<string> failures;
+    GrammarContext context;
+    context.SetThreads(1);
+    context.LoadString(grammar);
+    ostringstream whole;
+    context.RunTask(task, whole);
+    istringstream lines(whole.str());
+    vector<string> task_lines;
+    string line;
+    while (getline(lines, line))
+        task_lines.push_back(line);
+
+    const vector<string> &non_terminals = context.Types().non_terminals;
+    for (size_t n = non_terminals.size(); n-- > 0;)
+    {
+        ostringstream query;
+        context.RunQuery(task, {non_terminals[n]}, query);
+        if (n >= task_lines.size() || query.str() != task_lines[n] + "\n")
+        {
+            failures.push_back("--symbols=" + non_terminals[n] + " differs from its task line");
+            break;
+        }
+    }
+    return failures;
+}
+
+static string regressKey(const string &grammar, int task)
+{
+    return grammar + " " + to_string(task);
+}
+
+static bool readBaseline(const string &path, map<string, RegressResult> &baseline)
+// Lines of "grammar task hash phase:seconds:allocations...", # starts a comment
+{
+    ifstream file(path);
+    if (!file)
+        return false;
+    string line;
+    while (getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        istringstream fields(line);
+        string grammar, hash, phase;
+        int task;
+        if (!(fields >> grammar >> task >> hash))
+            continue;
+        RegressResult &result = baseline[regressKey(grammar, task)];
+        result.hash = strtoull(hash.c_str(), NULL, 16);
+        while (fields >> phase)
+        {
+            istringstream parts(phase);
+            string name, seconds, allocations;
+            if (!getline(parts, name, ':') || !getline(parts, seconds, ':') || !getline(parts, allocations))
+                continue;
+            for (int p = 0; p < STATS_PHASE_COUNT; p++)
+            {
+                if (name != statsPhaseName((StatsPhase)p))
+                    continue;
+                result.phases[p].seconds = atof(seconds.c_str());
+                result.phases[p].allocations = atoll(allocations.c_str());
+            }
+        }
+    }
+    return true;
+}
+
+static string formatResult(const string &grammar, int task, const RegressResult &result)
+{
+    char number[128];
+    snprintf(number, sizeof(number), "%s %d %016llx", grammar.c_str(), task, (unsigned long long)result.hash);
+    string line = number;
+    for (int p = 0; p < STATS_PHASE_COUNT; p++)
+    {
+        if (result.phases[p].seconds < 0)
+            continue;
+        snprintf(number, sizeof(number), " %s:%.6f:%lld", statsPhaseName((StatsPhase)p),
+                 result.phases[p].seconds, result.phases[p].allocations);
+        line += number;
+    }
+    return line + "\n";
+}
+
+static vector<string> compareResult(const RegressResult &result, const RegressResult &baseline, double time_budget, double alloc_budget)
+// One message per exceeded budget. Times are only compared with a budget
+// (>= 0), and get 2 ms of slack so that phases too short to measure do not
+// fail on noise
+{
+    vector<string> failures;
+    char message[256];
+    if (result.hash != baseline.hash)
+    {
+        snprintf(message, sizeof(message), "output hash %016llx, baseline %016llx",
+                 (unsigned long long)result.hash, (unsigned long long)baseline.hash);
+        failures.push_back(message);
+    }
+    for (int p = 0; p < STATS_PHASE_COUNT; p++)
+    {
+        const RegressPhase &now = result.phases[p];
+        const RegressPhase &then = baseline.phases[p];
+        if (now.seconds < 0 || then.seconds < 0)
+            continue;
+        double time_limit = then.seconds * (1 + time_budget) + 0.002;
+        if (time_budget >= 0 && now.seconds > time_limit)
+        {
+            snprintf(message, sizeof(message), "%s took %.6f s, budget %.6f s (baseline %.6f s)",
+                     statsPhaseName((StatsPhase)p), now.seconds, time_limit, then.seconds);
+            failures.push_back(message);
+        }
+        long long alloc_limit = then.allocations + (long long)(then.allocations * alloc_budget);
+        if (ALLOCATIONS_COUNTED && now.allocations > alloc_limit)
+        {
+            snprintf(message, sizeof(message), "%s made %lld allocations, budget %lld (baseline %lld)",
+                     statsPhaseName((StatsPhase)p), now.allocations, alloc_limit, then.allocations);
+            failures.push_back(message);
+        }
+    }
+    return failures;
+}
+
+static void regressUsage()
+{
+    cerr << "Usage: a.out regress [--baseline FILE] [--update] [--repeat N] [--tasks DIGITS]\n"
+         << "                     [--time-budget F] [--alloc-budget F]\n";
+}
+
+int runRegression(int argc, char *argv[])
+{
+    string baseline_path = "regress_baseline.txt";
+    bool update = false;
+    int repeat = 3;
+    string tasks = "123456789";
+    double time_budget = -1; // times of another machine, not checked by default
+    double alloc_budget = 0.1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string option = argv[i];
+        if (option == "--update")
+        {
+            update = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            regressUsage();
+            return 1;
+        }
+        string value = argv[++i];
+        if (option == "--baseline")
+            baseline_path = value;
+        else if (option == "--repeat")
+            repeat = max(1, atoi(value.c_str()));
+        else if (option == "--tasks")
+            tasks = value;
+        else if (option == "--time-budget")
+            time_budget = atof(value.c_str());
+        else if (option == "--alloc-budget")
+            alloc_budget = atof(value.c_str());
+        else
+        {
+            regressUsage();
+            return 1;
+        }
+    }
+
+    if (update && !ALLOCATIONS_COUNTED)
+    {
+        cerr << "Error: --update needs a build that counts allocations (-DCOUNT_ALLOCATIONS)\n";
+        return 1;
+    }
+    if (!ALLOCATIONS_COUNTED)
+        cout << "allocations are not counted in this build (-DCOUNT_ALLOCATIONS), so they are not checked\n";
+
+    map<string, RegressResult> baseline;
+    if (!update && !readBaseline(baseline_path, baseline))
+    {
+        cerr << "Error: cannot read baseline " << baseline_path << " (write one with --update)\n";
+        return 1;
+    }
+
+    string written = "# ./a.out regress baseline: grammar task output-hash phase:seconds:allocations...\n";
+    int failed = 0, checked = 0;
+    for (const RegressGrammar &grammar : regressCorpus())
+    {
+        string text = generateGrammar(grammar.params);
+        string sentences = regressSentences(grammar.params, text);
+        for (char t : tasks)
+        {
+            int task = t - '0';
+            if (task < 1 || task > 9)
+                continue;
+            RegressResult result;
+            for (int run = 0; run < repeat; run++)
+                regressRun(text, sentences, task, result);
+
+            if (update)
+            {
+                written += formatResult(grammar.name, task, result);
+                cout << grammar.name << " task " << task << ": recorded\n";
+                continue;
+            }
+            checked++;
+            auto expected = baseline.find(regressKey(grammar.name, task));
+            vector<string> failures;
+            if (expected == baseline.end())
+                failures.push_back("not in the baseline");
+            else
+                failures = compareResult(result, expected->second, time_budget, alloc_budget);
+            if (task == 2 || task == 3)
+            {
+                vector<string> query_failures = regressQueries(text, task);
+                failures.insert(failures.end(), query_failures.begin(), query_failures.end());
+            }
+            if (failures.empty())
+                cout << grammar.name << " task " << task << ": ok\n";
+            for (const string &failure : failures)
+                cout << grammar.name << " task " << task << ": FAIL " << failure << "\n";
+            failed += !failures.empty();
+            cout.flush();
+        }
+    }
+
+    if (update)
+    {
+        ofstream file(baseline_path);
+        if (!(file << written))
+        {
+            cerr << "Error: cannot write baseline " << baseline_path << "\n";
+            return 1;
+        }
+        return 0;
+    }
+    // Say which budgets were checked, the output hash always is
+    string budgets;
+    if (ALLOCATIONS_COUNTED)
+        budgets = "allocation";
+    if (time_budget >= 0)
+        budgets += budgets.empty() ? "time" : " and time";
+    cout << (checked - failed) << " of " << checked << " runs match the baseline output";
+    if (budgets.empty())
+        cout << "; no budget was checked\n";
+    else
+        cout << " within the " << budgets << " budget" << (time_budget >= 0 && ALLOCATIONS_COUNTED ? "s" : "") << "\n";
+    return failed ? 1 : 0;
+}
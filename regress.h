@@ -0,0 +1,33 @@
+/*
+ * Regression gate: ./a.out regress [options]
+ *
+ * Runs every task on a fixed corpus of generated grammars and compares
+ * each run with a stored baseline: the hash of the output must be the
+ * same, and the allocation count of every --stats phase must stay within a
+ * budget of the baseline. Wall times depend on the machine the baseline
+ * was written on, so they are only checked with --time-budget. Tasks 7
+ * and 8 get sentences drawn from the terminals of the grammar with the same seeded generator. For
+ * Tasks 2 and 3, --symbols must also print the task's line for every non
+ * terminal.
+ *
+ *   --baseline FILE      baseline to compare with or write
+ *                        (default regress_baseline.txt)
+ *   --update             measure and write the baseline instead
+ *   --repeat N           runs per grammar and task, the fastest counts (default 3)
+ *   --tasks DIGITS       tasks to run (default 123456789)
+ *   --time-budget F      check times too, allowed slowdown of a phase, 0.5 is
+ *                        50% (default: times are not checked)
+ *   --alloc-budget F     allowed growth of allocations (default 0.1)
+ *
+ * Allocations are only counted, and --update only works, in a build with
+ * -DCOUNT_ALLOCATIONS.
+ *
+ * Prints one line per grammar and task and exits with 1 if any output
+ * changed or any budget was exceeded.
+ */
+#ifndef __REGRESS__H__
+#define __REGRESS__H__
+
+int runRegression(int argc, char *argv[]);
+
+#endif //__REGRESS__H__
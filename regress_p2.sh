@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Allocations are only counted, and so checked against the baseline, in a
+# -DCOUNT_ALLOCATIONS build, so the check builds its own
+cd "$(dirname "$0")" || exit 1
+binary=$(mktemp /tmp/regress_p2.XXXXXX) || exit 1
+trap 'rm -f "$binary"' EXIT
+
+usage()
+{
+    echo
+    echo "Usage: $0 [--update] [regress options]"
+    echo
+    echo "Builds the analyzer with -DCOUNT_ALLOCATIONS, runs every task on the"
+    echo "generated regression corpus and compares output hashes and allocations"
+    echo "(phase times with --time-budget) with regress_baseline.txt."
+    echo "--update writes a new baseline instead. Run ./a.out regress --help"
+    echo "for the options."
+    echo
+    exit 1
+}
+
+if [ "$1" == "--help" ]; then
+    usage
+fi
+
+if ! g++ -std=c++17 -O2 -DCOUNT_ALLOCATIONS -pthread *.cc -o "$binary"; then
+    echo "Error: cannot build the analyzer with -DCOUNT_ALLOCATIONS"
+    exit 1
+fi
+
+"$binary" regress "$@"
+status=$?
+
+echo
+if [ "$status" -eq "0" ]; then
+    echo "Regression check passed"
+else
+    echo "Regression check FAILED"
+fi
+echo
+
+exit $status
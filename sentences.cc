@@ -0,0 +1,23 @@
+/*
+ * Sentences to recognize.
+ */
+#include <istream>
+#include <sstream>
+#include <string>
+
+#include "sentences.h"
+
+using namespace std;
+
+void readSentences(istream &in, Sentences &sentences)
+{
+    string line;
+    while (getline(in, line))
+    {
+        istringstream words(line);
+        sentences.emplace_back();
+        string word;
+        while (words >> word)
+            sentences.back().push_back(word);
+    }
+}
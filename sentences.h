@@ -0,0 +1,16 @@
+/*
+ * Sentences to recognize, one per line, words separated by white space.
+ * An empty line is the empty sentence.
+ */
+#ifndef __SENTENCES__H__
+#define __SENTENCES__H__
+
+#include <istream>
+#include <string>
+#include <vector>
+
+typedef std::vector<std::vector<std::string>> Sentences;
+
+void readSentences(std::istream &in, Sentences &sentences);
+
+#endif //__SENTENCES__H__
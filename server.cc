@@ -0,0 +1,400 @@
+/*
+ * Server mode: ./a.out serve [--socket=PATH]
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <poll.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "grammarcontext.h"
+#include "output.h"
+#include "server.h"
+
+using namespace std;
+
+struct LoadedGrammar
+// A grammar and the replies already computed for it
+{
+    GrammarContext context;
+    map<int, string> task_output;
+    unordered_map<string, string> first_lines;
+    unordered_map<string, string> follow_lines;
+    unordered_map<string, string> rule_lines;
+};
+
+class GrammarServer
+{
+  public:
+    GrammarServer() : stop(false) {}
+
+    // Reply to one request line; close is set when the client is done
+    string Handle(const string &line, bool &close);
+    bool Stopped() const { return stop; }
+
+  private:
+    string Load(const vector<string> &words);
+    string SetLines(const vector<string> &words, bool first);
+    string Rules(const vector<string> &words);
+    string Sentences(const vector<string> &words);
+    string Task(const vector<string> &words);
+    LoadedGrammar *Find(const string &name);
+    const string *TaskOutput(LoadedGrammar &grammar, int task, string &error);
+
+    unordered_map<string, unique_ptr<LoadedGrammar>> grammars;
+    bool stop;
+};
+
+static string ok(const string &payload)
+{
+    return "OK " + to_string(payload.size()) + "\n" + payload;
+}
+
+static string error(const string &message)
+{
+    return "ERROR " + message + "\n";
+}
+
+string GrammarServer::Handle(const string &line, bool &close)
+{
+    istringstream in(line);
+    vector<string> words;
+    string word;
+    while (in >> word)
+        words.push_back(word);
+    close = false;
+    if (words.empty())
+        return error("empty request");
+
+    const string &command = words[0];
+    if (command == "load")
+        return Load(words);
+    if (command == "first" || command == "follow")
+        return SetLines(words, command == "first");
+    if (command == "rules")
+        return Rules(words);
+    if (command == "task")
+        return Task(words);
+    if (command == "sentences")
+        return Sentences(words);
+    if (command == "unload")
+    {
+        if (words.size() != 2 || grammars.erase(words[1]) == 0)
+            return error("usage: unload NAME (of a loaded grammar)");
+        return ok("");
+    }
+    if (command == "list")
+    {
+        string names;
+        for (const auto &grammar : grammars)
+            names += grammar.first + "\n";
+        return ok(names);
+    }
+    if (command == "quit" || command == "shutdown")
+    {
+        close = true;
+        stop = stop || command == "shutdown";
+        return ok("");
+    }
+    return error("unknown request " + command);
+}
+
+LoadedGrammar *GrammarServer::Find(const string &name)
+{
+    auto it = grammars.find(name);
+    return it == grammars.end() ? nullptr : it->second.get();
+}
+
+string GrammarServer::Load(const vector<string> &words)
+{
+    if (words.size() != 3)
+        return error("usage: load NAME FILE");
+    ifstream file(words[2]);
+    if (!file)
+        return error("cannot open " + words[2]);
+    unique_ptr<LoadedGrammar> grammar(new LoadedGrammar);
+    if (grammar->context.Load(file) != GRAMMAR_OK)
+        return error("syntax error in " + words[2]);
+    size_t rule_count = grammar->context.Rules().size();
+    grammars[words[1]] = std::move(grammar);
+    return ok(to_string(rule_count) + " rules\n");
+}
+
+string GrammarServer::Sentences(const vector<string> &words)
+// The output of tasks 7 and 8 is for the sentences it was computed on
+{
+    if (words.size() != 3)
+        return error("usage: sentences NAME FILE");
+    LoadedGrammar *grammar = Find(words[1]);
+    if (!grammar)
+        return error("no grammar " + words[1]);
+    ifstream file(words[2]);
+    if (!file)
+        return error("cannot open " + words[2]);
+    grammar->context.LoadSentences(file);
+    grammar->task_output.erase(7);
+    grammar->task_output.erase(8);
+    return ok("");
+}
+
+string GrammarServer::SetLines(const vector<string> &words, bool first)
+{
+    if (words.size() < 3)
+        return error(string("usage: ") + (first ? "first" : "follow") + " NAME SYMBOL...");
+    LoadedGrammar *grammar = Find(words[1]);
+    if (!grammar)
+        return error("no grammar " + words[1]);
+
+    unordered_map<string, string> &cache = first ? grammar->first_lines : grammar->follow_lines;
+    string reply;
+    for (size_t i = 2; i < words.size(); i++)
+    {
+        auto cached = cache.find(words[i]);
+        if (cached == cache.end())
+        {
+            LazySets &sets = grammar->context.Lazy();
+            const vector<string> *set = first ? sets.First(words[i]) : sets.Follow(words[i]);
+            if (!set)
+                return error("unknown symbol " + words[i]);
+
+            vector<string> sorted = *set;
+            const CharacterType &c = grammar->context.Types();
+            if (first)
+                sortFirstSet(sorted, c);
+            else
+                sortFollowSet(sorted, c);
+            ostringstream line;
+            {
+                OutputWriter output(line);
+                printSet(output, first ? "FIRST" : "FOLLOW", words[i], sorted);
+            }
+            cached = cache.emplace(words[i], line.str()).first;
+        }
+        reply += cached->second;
+    }
+    return ok(reply);
+}
+
+const string *GrammarServer::TaskOutput(LoadedGrammar &grammar, int task, string &message)
+{
+    auto cached = grammar.task_output.find(task);
+    if (cached != grammar.task_output.end())
+        return &cached->second;
+
+    ostringstream out;
+    GrammarStatus status = grammar.context.RunTask(task, out);
+    if (status == GRAMMAR_BAD_TASK)
+    {
+        message = "unrecognized task number " + to_string(task);
+        return nullptr;
+    }
+    if (status == GRAMMAR_NO_SENTENCES)
+    {
+        message = "task " + to_string(task) + " needs sentences";
+        return nullptr;
+    }
+    // Task 5 output with epsilon rules is still the output the task prints
+    return &grammar.task_output.emplace(task, out.str()).first->second;
+}
+
+string GrammarServer::Task(const vector<string> &words)
+{
+    if (words.size() != 3)
+        return error("usage: task NAME N");
+    LoadedGrammar *grammar = Find(words[1]);
+    if (!grammar)
+        return error("no grammar " + words[1]);
+    string message;
+    const string *output = TaskOutput(*grammar, atoi(words[2].c_str()), message);
+    if (!output)
+        return error(message);
+    return ok(*output);
+}
+
+string GrammarServer::Rules(const vector<string> &words)
+{
+    if (words.size() != 3)
+        return error("usage: rules NAME NON-TERMINAL");
+    LoadedGrammar *grammar = Find(words[1]);
+    if (!grammar)
+        return error("no grammar " + words[1]);
+    const CharacterType &c = grammar->context.Types();
+    const string &non_terminal = words[2];
+    if (find(c.non_terminals.begin(), c.non_terminals.end(), non_terminal) == c.non_terminals.end())
+        return error("unknown non-terminal " + non_terminal);
+
+    auto cached = grammar->rule_lines.find(non_terminal);
+    if (cached != grammar->rule_lines.end())
+        return ok(cached->second);
+
+    string message;
+    const string *output = TaskOutput(*grammar, 4, message);
+    if (!output)
+        return error(message);
+    // Rules of the non terminal and of the names Task 4 made from it
+    const Task4Origins &origins = grammar->context.LastTask4Origins();
+    string lines;
+    istringstream in(*output);
+    string line;
+    while (getline(in, line))
+    {
+        string lhs = line.substr(0, line.find(' '));
+        auto origin = origins.find(lhs);
+        if (lhs == non_terminal || (origin != origins.end() && origin->second == non_terminal))
+            lines += line + "\n";
+    }
+    grammar->rule_lines.emplace(non_terminal, lines);
+    return ok(lines);
+}
+
+static bool writeAll(int fd, const string &data)
+// False if the client went away (EPIPE and the like); MSG_NOSIGNAL keeps
+// that from raising SIGPIPE, which would end the server
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t n = send(fd, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        written += n;
+    }
+    return true;
+}
+
+struct Client
+// A connection and the part of a request line read so far
+{
+    int fd;
+    string pending;
+};
+
+static bool serveClient(GrammarServer &server, Client &client)
+// Answers the whole lines of one read; false once the connection is done
+{
+    char buffer[65536];
+    ssize_t n = read(client.fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR)
+        return true;
+    if (n <= 0)
+        return false;
+    client.pending.append(buffer, n);
+    size_t start = 0, end;
+    bool close = false;
+    while (!close && (end = client.pending.find('\n', start)) != string::npos)
+    {
+        string reply = server.Handle(client.pending.substr(start, end - start), close);
+        if (!writeAll(client.fd, reply))
+            close = true;
+        start = end + 1;
+    }
+    client.pending.erase(0, start);
+    return !close;
+}
+
+static int serveSocket(GrammarServer &server, const char *path)
+// One thread serves every client: poll() says which connections have
+// requests, and each is answered in turn, so an idle client does not keep
+// the others waiting
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        cout << "Error: socket path too long\n";
+        return 1;
+    }
+    strcpy(address.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (listener < 0 || bind(listener, (sockaddr *)&address, sizeof(address)) != 0 || listen(listener, 16) != 0)
+    {
+        cout << "Error: cannot listen on " << path << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    vector<Client> clients;
+    vector<pollfd> polled;
+    while (!server.Stopped())
+    {
+        // The listener first, then the clients in the same order
+        polled.assign(1, {listener, POLLIN, 0});
+        for (const Client &client : clients)
+            polled.push_back({client.fd, POLLIN, 0});
+        if (poll(polled.data(), polled.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            bool open = true;
+            if (!server.Stopped() && polled[i + 1].revents)
+                open = serveClient(server, clients[i]);
+            if (!open || server.Stopped())
+                close(clients[i].fd);
+            else if (kept++ != i)
+                clients[kept - 1] = std::move(clients[i]);
+        }
+        clients.resize(kept);
+
+        if (!server.Stopped() && (polled[0].revents & POLLIN))
+        {
+            int client = accept(listener, nullptr, nullptr);
+            // A client that gave up before it was accepted ends only itself
+            if (client >= 0)
+                clients.push_back({client, string()});
+            else if (errno != EINTR && errno != ECONNABORTED)
+                break;
+        }
+    }
+    for (const Client &client : clients)
+        close(client.fd);
+    close(listener);
+    unlink(path);
+    return 0;
+}
+
+int runServer(int argc, char *argv[])
+{
+    const char *socket_path = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--socket=", 9) == 0)
+            socket_path = argv[i] + 9;
+        else
+        {
+            cout << "Error: unrecognized option " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    GrammarServer server;
+    if (socket_path)
+        return serveSocket(server, socket_path);
+
+    string line;
+    bool close = false;
+    while (!close && getline(cin, line))
+        cout << server.Handle(line, close) << flush;
+    return 0;
+}
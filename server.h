@@ -0,0 +1,32 @@
+/*
+ * Server mode: ./a.out serve [--socket=PATH]
+ *
+ * Loads grammars once and answers queries about them, one request per
+ * line, from standard input or from clients of a Unix domain socket. One
+ * thread serves every socket client, answering requests as they come in.
+ * Everything computed for a grammar (FIRST and FOLLOW sets, task output)
+ * stays in memory until the grammar is unloaded.
+ *
+ *   load NAME FILE       read the grammar in FILE as NAME
+ *   first NAME X...      FIRST(X) lines, as printed by Task 2
+ *   follow NAME X...     FOLLOW(X) lines, as printed by Task 3
+ *   rules NAME X         the rules of X and of the non terminals Task 4
+ *                        made from it, as printed by Task 4
+ *   sentences NAME FILE  read the sentences in FILE for tasks 7 and 8,
+ *                        replacing the ones read before
+ *   task NAME N          the whole output of task N (1 to 9); tasks 7 and
+ *                        8 need sentences first
+ *   unload NAME
+ *   list                 the loaded grammars
+ *   quit                 close this connection (stop reading stdin)
+ *   shutdown             stop the server
+ *
+ * A reply is "OK <bytes>\n" followed by that many bytes, or a single
+ * "ERROR <message>\n" line.
+ */
+#ifndef __SERVER__H__
+#define __SERVER__H__
+
+int runServer(int argc, char *argv[]);
+
+#endif //__SERVER__H__
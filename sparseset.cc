@@ -0,0 +1,196 @@
+/*
+ * A set of small non negative integers that takes memory in proportion
+ * to what it holds.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "sparseset.h"
+
+using namespace std;
+
+static bool testBit(const vector<uint64_t> &bitmap, uint16_t low)
+{
+    return bitmap[low / 64] >> (low % 64) & 1;
+}
+
+SparseSet::Container *SparseSet::Find(uint16_t key)
+{
+    auto it = lower_bound(containers.begin(), containers.end(), key,
+                          [](const Container &container, uint16_t key)
+                          { return container.key < key; });
+    if (it == containers.end() || it->key != key)
+        return nullptr;
+    return &*it;
+}
+
+const SparseSet::Container *SparseSet::Find(uint16_t key) const
+{
+    return const_cast<SparseSet *>(this)->Find(key);
+}
+
+SparseSet::Container &SparseSet::FindOrAdd(uint16_t key)
+{
+    auto it = lower_bound(containers.begin(), containers.end(), key,
+                          [](const Container &container, uint16_t key)
+                          { return container.key < key; });
+    if (it == containers.end() || it->key != key)
+    {
+        it = containers.insert(it, Container());
+        it->key = key;
+        it->count = 0;
+    }
+    return *it;
+}
+
+void SparseSet::ToBitmap(Container &container)
+{
+    container.bitmap.assign(BITMAP_WORDS, 0);
+    for (uint16_t low : container.array)
+        container.bitmap[low / 64] |= uint64_t(1) << (low % 64);
+    vector<uint16_t>().swap(container.array);
+}
+
+bool SparseSet::Insert(uint32_t value)
+{
+    Container &container = FindOrAdd(value >> 16);
+    uint16_t low = value & 0xffff;
+    if (!container.bitmap.empty())
+    {
+        uint64_t &word = container.bitmap[low / 64];
+        uint64_t bit = uint64_t(1) << (low % 64);
+        if (word & bit)
+            return false;
+        word |= bit;
+    }
+    else
+    {
+        auto it = lower_bound(container.array.begin(), container.array.end(), low);
+        if (it != container.array.end() && *it == low)
+            return false;
+        container.array.insert(it, low);
+        if (container.array.size() > ARRAY_MAX)
+            ToBitmap(container);
+    }
+    container.count++;
+    size++;
+    return true;
+}
+
+bool SparseSet::Contains(uint32_t value) const
+{
+    const Container *container = Find(value >> 16);
+    if (!container)
+        return false;
+    uint16_t low = value & 0xffff;
+    if (!container->bitmap.empty())
+        return testBit(container->bitmap, low);
+    return binary_search(container->array.begin(), container->array.end(), low);
+}
+
+size_t SparseSet::Union(Container &to, const Container &from)
+// Adds from to to, returns the number of new elements
+{
+    size_t before = to.count;
+    if (from.bitmap.empty() && to.bitmap.empty())
+    {
+        // Both arrays: merge, and keep it an array if it still fits
+        vector<uint16_t> merged;
+        merged.reserve(to.array.size() + from.array.size());
+        set_union(to.array.begin(), to.array.end(), from.array.begin(), from.array.end(), back_inserter(merged));
+        if (merged.size() == to.array.size())
+            return 0;
+        to.array.swap(merged);
+        to.count = to.array.size();
+        if (to.array.size() > ARRAY_MAX)
+            ToBitmap(to);
+        return to.count - before;
+    }
+
+    if (to.bitmap.empty())
+        ToBitmap(to);
+    if (from.bitmap.empty())
+    {
+        for (uint16_t low : from.array)
+        {
+            uint64_t &word = to.bitmap[low / 64];
+            uint64_t bit = uint64_t(1) << (low % 64);
+            to.count += (word & bit) == 0;
+            word |= bit;
+        }
+        return to.count - before;
+    }
+    for (size_t w = 0; w < BITMAP_WORDS; w++)
+    {
+        uint64_t added = from.bitmap[w] & ~to.bitmap[w];
+        if (added)
+        {
+            to.count += __builtin_popcountll(added);
+            to.bitmap[w] |= added;
+        }
+    }
+    return to.count - before;
+}
+
+size_t SparseSet::UnionWith(const SparseSet &other)
+{
+    if (&other == this)
+        return 0;
+    size_t added = 0;
+    for (const Container &from : other.containers)
+    {
+        if (from.count == 0)
+            continue;
+        added += Union(FindOrAdd(from.key), from);
+    }
+    size += added;
+    return added;
+}
+
+bool SparseSet::Includes(const Container &set, const Container &subset)
+{
+    if (subset.count > set.count)
+        return false;
+    if (subset.bitmap.empty())
+    {
+        if (set.bitmap.empty())
+            return includes(set.array.begin(), set.array.end(), subset.array.begin(), subset.array.end());
+        for (uint16_t low : subset.array)
+        {
+            if (!testBit(set.bitmap, low))
+                return false;
+        }
+        return true;
+    }
+    // A bitmap has more elements than any array, so set is a bitmap here
+    for (size_t w = 0; w < BITMAP_WORDS; w++)
+    {
+        if (subset.bitmap[w] & ~set.bitmap[w])
+            return false;
+    }
+    return true;
+}
+
+bool SparseSet::Includes(const SparseSet &other) const
+{
+    if (other.size > size)
+        return false;
+    for (const Container &subset : other.containers)
+    {
+        if (subset.count == 0)
+            continue;
+        const Container *set = Find(subset.key);
+        if (!set || !Includes(*set, subset))
+            return false;
+    }
+    return true;
+}
+
+size_t SparseSet::MemoryBytes() const
+{
+    size_t bytes = containers.capacity() * sizeof(Container);
+    for (const Container &container : containers)
+        bytes += container.array.capacity() * sizeof(uint16_t) + container.bitmap.capacity() * sizeof(uint64_t);
+    return bytes;
+}
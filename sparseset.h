@@ -0,0 +1,92 @@
+/*
+ * A set of small non negative integers that takes memory in proportion
+ * to what it holds.
+ *
+ * The numbers are split by their high 16 bits into containers of 65536
+ * values each (the layout of roaring bitmaps). A container holds a sorted
+ * array of the low 16 bits while it has at most 4096 elements, and is
+ * turned into a bitmap of 1024 words when it grows past that, the size at
+ * which the bitmap is smaller. A set of a few symbols out of a large
+ * alphabet costs a few bytes, a set holding most of a block of the
+ * alphabet costs one bit per symbol. Unions work container by container
+ * on any mix of arrays and bitmaps.
+ *
+ * Sets only grow, there is no removal.
+ */
+#ifndef __SPARSESET__H__
+#define __SPARSESET__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// FIRST and FOLLOW use sparse sets when the grammar has at least this many
+// terminals, and the plain vectors of names below it
+#ifndef SPARSE_SET_MIN_TERMINALS
+#define SPARSE_SET_MIN_TERMINALS 16
+#endif
+
+class SparseSet
+{
+  public:
+    SparseSet() : size(0) {}
+
+    // Returns true if value was not in the set
+    bool Insert(uint32_t value);
+    bool Contains(uint32_t value) const;
+    // Adds every element of other, returns how many were new
+    std::size_t UnionWith(const SparseSet &other);
+    // True if every element of other is in this set
+    bool Includes(const SparseSet &other) const;
+
+    std::size_t Size() const { return size; }
+    bool Empty() const { return size == 0; }
+    // Heap memory used by the containers
+    std::size_t MemoryBytes() const;
+
+    // Calls f(value) for every element in ascending order
+    template <typename F>
+    void ForEach(F f) const
+    {
+        for (const Container &container : containers)
+        {
+            uint32_t high = uint32_t(container.key) << 16;
+            if (container.bitmap.empty())
+            {
+                for (uint16_t low : container.array)
+                    f(high | low);
+                continue;
+            }
+            for (std::size_t w = 0; w < BITMAP_WORDS; w++)
+            {
+                for (uint64_t bits = container.bitmap[w]; bits; bits &= bits - 1)
+                    f(high | uint32_t(w * 64 + __builtin_ctzll(bits)));
+            }
+        }
+    }
+
+  private:
+    static const std::size_t ARRAY_MAX = 4096;
+    static const std::size_t BITMAP_WORDS = 1024;
+
+    struct Container
+    {
+        uint16_t key;
+        uint32_t count;
+        std::vector<uint16_t> array; // sorted, used while bitmap is empty
+        std::vector<uint64_t> bitmap;
+    };
+
+    Container *Find(uint16_t key);
+    const Container *Find(uint16_t key) const;
+    Container &FindOrAdd(uint16_t key);
+
+    static void ToBitmap(Container &container);
+    static std::size_t Union(Container &to, const Container &from);
+    static bool Includes(const Container &set, const Container &subset);
+
+    std::vector<Container> containers; // ascending keys
+    std::size_t size;
+};
+
+#endif //__SPARSESET__H__
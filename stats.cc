@@ -0,0 +1,188 @@
+/*
+ * Run statistics printed by --stats.
+ */
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+#include <sys/resource.h>
+
+#include "stats.h"
+
+using namespace std;
+
+thread_local RunStats stats;
+
+#ifdef COUNT_ALLOCATIONS
+
+// Per thread, so that the counts of a phase are those of the thread that
+// ran it, and counting takes no atomic operation
+static thread_local long long thread_allocated_bytes = 0;
+static thread_local long long thread_allocations = 0;
+
+static void *countedAllocation(size_t size, size_t alignment)
+{
+    thread_allocated_bytes += size;
+    thread_allocations++;
+    if (size == 0)
+        size = 1;
+    if (alignment <= alignof(max_align_t))
+        return malloc(size);
+    // aligned_alloc wants a multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void *countedNew(size_t size, size_t alignment)
+{
+    void *p = countedAllocation(size, alignment);
+    if (!p)
+        throw bad_alloc();
+    return p;
+}
+
+// Every form of new allocates with malloc or aligned_alloc, so every form
+// of delete frees with free
+void *operator new(size_t size) { return countedNew(size, 0); }
+void *operator new[](size_t size) { return countedNew(size, 0); }
+void *operator new(size_t size, align_val_t alignment) { return countedNew(size, (size_t)alignment); }
+void *operator new[](size_t size, align_val_t alignment) { return countedNew(size, (size_t)alignment); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return countedAllocation(size, 0); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return countedAllocation(size, 0); }
+void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept { return countedAllocation(size, (size_t)alignment); }
+void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept { return countedAllocation(size, (size_t)alignment); }
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+void operator delete(void *p, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, align_val_t) noexcept { free(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { free(p); }
+void operator delete(void *p, const nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, const nothrow_t &) noexcept { free(p); }
+void operator delete(void *p, align_val_t, const nothrow_t &) noexcept { free(p); }
+void operator delete[](void *p, align_val_t, const nothrow_t &) noexcept { free(p); }
+
+long long allocatedBytes()
+{
+    return thread_allocated_bytes;
+}
+
+long long allocationCount()
+{
+    return thread_allocations;
+}
+
+#else
+
+long long allocatedBytes()
+{
+    return 0;
+}
+
+long long allocationCount()
+{
+    return 0;
+}
+
+#endif
+
+static const char *stats_phase_names[STATS_PHASE_COUNT] = {
+    "lex", "readGrammar", "fetchTypes", "findFirstSets", "findFollowSets", "task"};
+
+const char *statsPhaseName(StatsPhase phase)
+{
+    return stats_phase_names[phase];
+}
+
+StatsTimer::StatsTimer(StatsPhase phase)
+    : phase(phase), running(true), start(chrono::steady_clock::now()),
+      start_bytes(allocatedBytes()), start_allocations(allocationCount())
+{
+}
+
+StatsTimer::~StatsTimer()
+{
+    Stop();
+}
+
+void StatsTimer::Stop()
+{
+    if (!running)
+        return;
+    running = false;
+    stats.seconds[phase] += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    stats.calls[phase]++;
+    stats.allocated_bytes[phase] += allocatedBytes() - start_bytes;
+    stats.allocations[phase] += allocationCount() - start_allocations;
+}
+
+long peakRssKb()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+    return usage.ru_maxrss; // kilobytes on Linux
+}
+
+void printStats(ostream &out, bool json)
+// The allocation figures only in a build that counts them
+{
+    const char *counter_names[] = {
+        "tokens_lexed", "rules_loaded", "first_passes", "first_insertions",
+        "follow_passes", "follow_insertions", "rules_created", "rules_removed",
+        "peak_rss_kb", "allocations", "allocated_bytes"};
+    long long counters[] = {
+        stats.tokens_lexed, stats.rules_loaded, stats.first_passes, stats.first_insertions,
+        stats.follow_passes, stats.follow_insertions, stats.rules_created, stats.rules_removed,
+        peakRssKb(), allocationCount(), allocatedBytes()};
+    const int counter_count = sizeof(counters) / sizeof(counters[0]) - (ALLOCATIONS_COUNTED ? 0 : 2);
+    char number[128];
+
+    if (json)
+    {
+        out << "{\"seconds\": {";
+        for (int p = 0; p < STATS_PHASE_COUNT; p++)
+        {
+            snprintf(number, sizeof(number), "%.9f", stats.seconds[p]);
+            out << (p ? ", " : "") << "\"" << stats_phase_names[p] << "\": " << number;
+        }
+        out << "}, \"calls\": {";
+        for (int p = 0; p < STATS_PHASE_COUNT; p++)
+            out << (p ? ", " : "") << "\"" << stats_phase_names[p] << "\": " << stats.calls[p];
+        out << "}";
+        if (ALLOCATIONS_COUNTED)
+        {
+            out << ", \"allocated_bytes\": {";
+            for (int p = 0; p < STATS_PHASE_COUNT; p++)
+                out << (p ? ", " : "") << "\"" << stats_phase_names[p] << "\": " << stats.allocated_bytes[p];
+            out << "}, \"allocations\": {";
+            for (int p = 0; p < STATS_PHASE_COUNT; p++)
+                out << (p ? ", " : "") << "\"" << stats_phase_names[p] << "\": " << stats.allocations[p];
+            out << "}";
+        }
+        for (int i = 0; i < counter_count; i++)
+            out << ", \"" << counter_names[i] << "\": " << counters[i];
+        out << "}\n";
+        return;
+    }
+
+    for (int p = 0; p < STATS_PHASE_COUNT; p++)
+    {
+        if (ALLOCATIONS_COUNTED)
+            snprintf(number, sizeof(number), "%-20s %12.6f s %14lld bytes %10lld allocations  (%ld calls)\n",
+                     stats_phase_names[p], stats.seconds[p], stats.allocated_bytes[p],
+                     stats.allocations[p], stats.calls[p]);
+        else
+            snprintf(number, sizeof(number), "%-20s %12.6f s  (%ld calls)\n",
+                     stats_phase_names[p], stats.seconds[p], stats.calls[p]);
+        out << number;
+    }
+    for (int i = 0; i < counter_count; i++)
+    {
+        snprintf(number, sizeof(number), "%-20s %12lld\n", counter_names[i], counters[i]);
+        out << number;
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Run statistics printed by --stats: wall time per phase and counters for
+ * the FIRST/FOLLOW fixpoints and the Task4/Task5 rewrites.
+ */
+#ifndef __STATS__H__
+#define __STATS__H__
+
+#include <chrono>
+#include <ostream>
+
+typedef enum {
+    STATS_LEX = 0,
+    STATS_READ_GRAMMAR,
+    STATS_FETCH_TYPES,
+    STATS_FIRST_SETS,
+    STATS_FOLLOW_SETS,
+    STATS_TASK,
+    STATS_PHASE_COUNT
+} StatsPhase;
+
+struct RunStats
+{
+    double seconds[STATS_PHASE_COUNT] = {};
+    long calls[STATS_PHASE_COUNT] = {};
+    long long allocated_bytes[STATS_PHASE_COUNT] = {};
+    long long allocations[STATS_PHASE_COUNT] = {};
+    long tokens_lexed = 0;
+    long rules_loaded = 0;
+    long first_passes = 0;
+    long first_insertions = 0;
+    long follow_passes = 0;
+    long follow_insertions = 0;
+    long rules_created = 0;
+    long rules_removed = 0;
+};
+
+// One per thread, so each thread running a GrammarContext counts its own work
+extern thread_local RunStats stats;
+
+class StatsTimer
+// Adds the time between construction and Stop() (or destruction) to a phase
+{
+  public:
+    explicit StatsTimer(StatsPhase phase);
+    ~StatsTimer();
+    void Stop();
+
+  private:
+    StatsPhase phase;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+    long long start_bytes;
+    long long start_allocations;
+};
+
+// Allocations are counted by replacement operator new and delete, only in
+// a build with -DCOUNT_ALLOCATIONS; otherwise the counts stay 0
+#ifdef COUNT_ALLOCATIONS
+const bool ALLOCATIONS_COUNTED = true;
+#else
+const bool ALLOCATIONS_COUNTED = false;
+#endif
+
+// Totals of the calling thread since it started
+long long allocatedBytes();
+long long allocationCount();
+
+// Name printed for the phase ("lex", "readGrammar", ...)
+const char *statsPhaseName(StatsPhase phase);
+
+long peakRssKb();
+void printStats(std::ostream &out, bool json);
+
+#endif //__STATS__H__
@@ -0,0 +1,221 @@
+/*
+ * Machine readable task output: --format=json and --format=binary.
+ */
+#include <algorithm>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "structured.h"
+
+using namespace std;
+
+static size_t varintBytes(unsigned long long value)
+{
+    size_t bytes = 1;
+    for (; value >= 0x80; value >>= 7)
+        bytes++;
+    return bytes;
+}
+
+StructuredWriter::StructuredWriter(ostream &out, OutputFormat format, int task)
+    : output(out), format(format), symbol_count(0), section(nullptr)
+{
+    if (format == OUTPUT_BINARY)
+    {
+        output << "GRMB" << (char)1;
+        Varint(task);
+    }
+    else
+        output << "{\"task\": " << (long long)task;
+}
+
+StructuredWriter::~StructuredWriter()
+{
+    if (format == OUTPUT_BINARY)
+        output << 'E';
+    else
+        output << (section ? "]}\n" : "}\n");
+}
+
+void StructuredWriter::Varint(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        output << (char)((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    output << (char)value;
+}
+
+void StructuredWriter::Section(const char *name)
+// JSON only, opens the list the next records go into
+{
+    if (section == name)
+    {
+        output << ",\n";
+        return;
+    }
+    output << (section ? "],\n\"" : ",\n\"") << name << "\": [\n";
+    section = name;
+}
+
+void StructuredWriter::Symbols(const vector<string> &names, size_t terminal_count)
+{
+    symbol_count = names.size();
+    if (format == OUTPUT_BINARY)
+    {
+        Varint(names.size());
+        Varint(terminal_count);
+        for (const string &name : names)
+        {
+            Varint(name.size());
+            output << name;
+        }
+        return;
+    }
+
+    // Symbol names are IDs, "#" or "$", none of them needs escaping
+    output << ", \"terminals\": " << (long long)terminal_count << ", \"symbols\": [";
+    for (size_t s = 0; s < names.size(); s++)
+        output << (s ? ", \"" : "\"") << names[s] << '"';
+    output << ']';
+}
+
+void StructuredWriter::Set(int symbol, const vector<int> &ids)
+{
+    if (format == OUTPUT_JSON)
+    {
+        Section("sets");
+        output << '[' << (long long)symbol << ", [";
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            if (i)
+                output << ", ";
+            output << (long long)ids[i];
+        }
+        output << "]]";
+        return;
+    }
+
+    output << 'S';
+    Varint(symbol);
+    size_t list_bytes = varintBytes(ids.size());
+    for (size_t i = 0; i < ids.size(); i++)
+        list_bytes += varintBytes(ids[i] - (i ? ids[i - 1] : 0));
+    size_t bitset_bytes = (symbol_count + 7) / 8;
+    if (list_bytes <= bitset_bytes)
+    {
+        output << (char)0;
+        Varint(ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+            Varint(ids[i] - (i ? ids[i - 1] : 0));
+        return;
+    }
+    output << (char)1;
+    string bits(bitset_bytes, '\0');
+    for (int id : ids)
+        bits[id / 8] |= 1 << (id % 8);
+    output << bits;
+}
+
+void StructuredWriter::Rule(int lhs, const vector<int> &rhs)
+{
+    if (format == OUTPUT_JSON)
+    {
+        Section("rules");
+        output << '[' << (long long)lhs << ", [";
+        for (size_t i = 0; i < rhs.size(); i++)
+        {
+            if (i)
+                output << ", ";
+            output << (long long)rhs[i];
+        }
+        output << "]]";
+        return;
+    }
+
+    output << 'R';
+    Varint(lhs);
+    Varint(rhs.size());
+    for (int symbol : rhs)
+        Varint(symbol);
+}
+
+vector<string> structuredSymbols(const CharacterType &c)
+{
+    vector<string> names = {"#", "$"};
+    for (const string &terminal : c.terminals)
+    {
+        if (terminal != "#")
+            names.push_back(terminal);
+    }
+    names.insert(names.end(), c.non_terminals.begin(), c.non_terminals.end());
+    return names;
+}
+
+void writeStructuredSymbols(ostream &out, OutputFormat format, const CharacterType &c)
+{
+    StructuredWriter writer(out, format, 1);
+    vector<string> names = structuredSymbols(c);
+    writer.Symbols(names, names.size() - c.non_terminals.size());
+}
+
+void writeStructuredSets(ostream &out, OutputFormat format, int task, const CharacterType &c, const Fsets &sets)
+{
+    StructuredWriter writer(out, format, task);
+    vector<string> names = structuredSymbols(c);
+    size_t terminal_count = names.size() - c.non_terminals.size();
+    writer.Symbols(names, terminal_count);
+
+    unordered_map<string, int> ids;
+    for (size_t s = 0; s < names.size(); s++)
+        ids.emplace(names[s], s);
+    vector<int> set_ids;
+    for (size_t n = 0; n < c.non_terminals.size(); n++)
+    {
+        set_ids.clear();
+        auto set = sets.find(c.non_terminals[n]);
+        if (set != sets.end())
+        {
+            for (const string &element : set->second)
+                set_ids.push_back(ids.at(element));
+        }
+        sort(set_ids.begin(), set_ids.end());
+        writer.Set(terminal_count + n, set_ids);
+    }
+}
+
+void writeStructuredRules(ostream &out, OutputFormat format, int task, const CharacterType &c, const ProductionTable &table, const vector<ProductionId> &rules)
+// Symbols of table that are not in the grammar are the ones the task made
+// up, they go after the non terminals
+{
+    vector<string> names = structuredSymbols(c);
+    size_t terminal_count = names.size() - c.non_terminals.size();
+    unordered_map<string, int> known;
+    for (size_t s = 0; s < names.size(); s++)
+        known.emplace(names[s], s);
+    vector<int> ids(table.Symbols());
+    for (size_t s = 0; s < table.Symbols(); s++)
+    {
+        auto found = known.emplace(table.Name(s), names.size());
+        if (found.second)
+            names.push_back(table.Name(s));
+        ids[s] = found.first->second;
+    }
+
+    StructuredWriter writer(out, format, task);
+    writer.Symbols(names, terminal_count);
+    vector<int> rhs;
+    for (ProductionId rule : rules)
+    {
+        rhs.clear();
+        for (SymbolId symbol : table.Rhs(rule))
+        {
+            if (ids[symbol] != 0)
+                rhs.push_back(ids[symbol]);
+        }
+        writer.Rule(ids[table.Lhs(rule)], rhs);
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Machine readable task output: --format=json and --format=binary.
+ *
+ * The symbol table is written once, then every set or rule refers to
+ * symbols by their position in it. Ids are the same for Task 1 to Task 5
+ * on one grammar: "#" is 0, "$" is 1, then the terminals and then the non
+ * terminals in order of appearance, then the non terminals Task 4 or Task 5
+ * made. Sets are ascending ids, which is also the order Task 2 and Task 3
+ * print them in, and rules are listed in the order the text output has.
+ *
+ * JSON, one record per line so that it can be read as a stream:
+ *
+ *   {"task": 2, "terminals": 7, "symbols": ["#", "$", "a", ..., "S", ...],
+ *   "sets": [
+ *   [8, [0, 2, 3]],                    FIRST(S) = { #, a, b }
+ *   ...],
+ *   "rules": [
+ *   [8, [2, 8]],                       S -> a S
+ *   ...]}
+ *
+ * Binary, integers as LEB128 varints:
+ *
+ *   "GRMB" 1 task
+ *   symbol_count terminal_count (length bytes)...
+ *   'S' symbol 0 count id...          set as a list of id gaps
+ *   'S' symbol 1 bitset               set as symbol_count bits, LSB first
+ *   'R' lhs count id...               rule
+ *   'E'
+ *
+ * Each set is written in whichever of the two forms is smaller. The first
+ * terminal_count symbols are "#", "$" and the terminals.
+ */
+#ifndef __STRUCTURED__H__
+#define __STRUCTURED__H__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "output.h"
+#include "productions.h"
+#include "project2.h"
+
+class StructuredWriter
+{
+  public:
+    // format is OUTPUT_JSON or OUTPUT_BINARY
+    StructuredWriter(std::ostream &out, OutputFormat format, int task);
+    // Ends the document
+    ~StructuredWriter();
+
+    // Once, before any set or rule
+    void Symbols(const std::vector<std::string> &names, std::size_t terminal_count);
+    // ids ascending
+    void Set(int symbol, const std::vector<int> &ids);
+    void Rule(int lhs, const std::vector<int> &rhs);
+
+  private:
+    StructuredWriter(const StructuredWriter &) = delete;
+    StructuredWriter &operator=(const StructuredWriter &) = delete;
+
+    void Section(const char *name);
+    void Varint(unsigned long long value);
+
+    OutputWriter output;
+    OutputFormat format;
+    std::size_t symbol_count;
+    const char *section;
+};
+
+// The symbols of the grammar in the order described above
+std::vector<std::string> structuredSymbols(const CharacterType &c);
+
+// Task 1: only the symbol table
+void writeStructuredSymbols(std::ostream &out, OutputFormat format, const CharacterType &c);
+// Task 2 and Task 3: the set of every non terminal
+void writeStructuredSets(std::ostream &out, OutputFormat format, int task, const CharacterType &c, const Fsets &sets);
+// Task 4 and Task 5: rules of table, "#" left out of the right hand sides
+void writeStructuredRules(std::ostream &out, OutputFormat format, int task, const CharacterType &c, const ProductionTable &table, const std::vector<ProductionId> &rules);
+
+#endif //__STRUCTURED__H__
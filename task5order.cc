@@ -0,0 +1,228 @@
+/*
+ * Order in which Task5 eliminates left recursion.
+ */
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "task5order.h"
+
+using namespace std;
+
+vector<SymbolId> lexicographicOrder(const ProductionTable &table, const Task5Groups &groups)
+{
+    vector<SymbolId> order;
+    for (size_t symbol = 0; symbol < groups.size(); symbol++)
+        order.push_back(symbol);
+    sort(order.begin(), order.end(), [&table](SymbolId a, SymbolId b)
+         { return table.Name(a) < table.Name(b); });
+    return order;
+}
+
+double predictTask5Rules(const ProductionTable &table, const Task5Groups &groups, const vector<SymbolId> &order)
+{
+    // Rules are counted by their first symbol: non terminals by position
+    // in the order, any other symbol after all of them
+    long n = order.size();
+    vector<long> position(table.Symbols(), -1);
+    for (long i = 0; i < n; i++)
+        position[order[i]] = i;
+    vector<map<long, double>> first(n);
+    for (long i = 0; i < n; i++)
+    {
+        for (ProductionId production : groups[order[i]])
+        {
+            SymbolId symbol = table.Rhs(production)[0];
+            first[i][position[symbol] >= 0 ? position[symbol] : n + symbol] += 1;
+        }
+    }
+
+    double rules = 0;
+    for (long i = 0; i < n; i++)
+    {
+        map<long, double> &counts = first[i];
+        // Substituting Aj brings in rules starting with Ak, k > j, which are
+        // substituted in turn if k < i
+        while (!counts.empty() && counts.begin()->first < i)
+        {
+            long j = counts.begin()->first;
+            double copies = counts.begin()->second;
+            counts.erase(counts.begin());
+            for (const auto &count : first[j])
+                counts[count.first] += copies * count.second;
+        }
+        // Left recursive rules move to the new non terminal, the others
+        // stay and no longer start with Ai
+        auto recursive = counts.find(i);
+        if (recursive != counts.end())
+        {
+            rules += recursive->second;
+            counts.erase(recursive);
+        }
+        for (const auto &count : counts)
+            rules += count.second;
+    }
+    return rules;
+}
+
+static vector<vector<SymbolId>> leftCornerComponents(const vector<vector<SymbolId>> &edges)
+// Tarjan's algorithm, iterative. A component comes out after every
+// component it has an edge to.
+{
+    int count = edges.size();
+    vector<int> index(count, -1), low(count, 0);
+    vector<bool> on_stack(count, false);
+    vector<int> stack;
+    struct Frame
+    {
+        int x;
+        size_t edge;
+    };
+    vector<Frame> calls;
+    vector<vector<SymbolId>> components;
+    int next_index = 0;
+
+    for (int root = 0; root < count; root++)
+    {
+        if (index[root] >= 0)
+            continue;
+        index[root] = low[root] = next_index++;
+        stack.push_back(root);
+        on_stack[root] = true;
+        calls.push_back({root, 0});
+        while (!calls.empty())
+        {
+            int x = calls.back().x;
+            if (calls.back().edge < edges[x].size())
+            {
+                int y = edges[x][calls.back().edge++];
+                if (index[y] < 0)
+                {
+                    index[y] = low[y] = next_index++;
+                    stack.push_back(y);
+                    on_stack[y] = true;
+                    calls.push_back({y, 0});
+                }
+                else if (on_stack[y])
+                    low[x] = min(low[x], index[y]);
+                continue;
+            }
+
+            if (low[x] == index[x])
+            {
+                components.emplace_back();
+                int top;
+                do
+                {
+                    top = stack.back();
+                    stack.pop_back();
+                    on_stack[top] = false;
+                    components.back().push_back(top);
+                } while (top != x);
+            }
+            calls.pop_back();
+            if (!calls.empty())
+            {
+                int parent = calls.back().x;
+                low[parent] = min(low[parent], low[x]);
+            }
+        }
+    }
+    return components;
+}
+
+static vector<vector<SymbolId>> leftCornerEdges(const ProductionTable &table, const Task5Groups &groups)
+{
+    SymbolId n = groups.size();
+    vector<vector<SymbolId>> edges(n);
+    for (SymbolId a = 0; a < n; a++)
+    {
+        for (ProductionId production : groups[a])
+        {
+            SymbolId b = table.Rhs(production)[0];
+            if (b < n && b != a)
+                edges[a].push_back(b);
+        }
+    }
+    return edges;
+}
+
+vector<SymbolId> dependencyOrder(const ProductionTable &table, const Task5Groups &groups, double &predicted_rules)
+{
+    SymbolId n = groups.size();
+    vector<vector<SymbolId>> edges = leftCornerEdges(table, groups);
+    vector<vector<SymbolId>> components = leftCornerComponents(edges);
+    reverse(components.begin(), components.end());
+
+    vector<int> component_of(n);
+    for (size_t k = 0; k < components.size(); k++)
+    {
+        for (SymbolId a : components[k])
+            component_of[a] = k;
+    }
+    vector<double> copied(n, 0);
+    for (SymbolId a = 0; a < n; a++)
+    {
+        for (SymbolId b : edges[a])
+        {
+            if (component_of[b] == component_of[a])
+                copied[b] += groups[b].size();
+        }
+    }
+
+    vector<SymbolId> order;
+    for (vector<SymbolId> &component : components)
+    {
+        sort(component.begin(), component.end(), [&](SymbolId a, SymbolId b)
+             {
+                 if (copied[a] != copied[b])
+                     return copied[a] < copied[b];
+                 return table.Name(a) < table.Name(b);
+             });
+        order.insert(order.end(), component.begin(), component.end());
+    }
+
+    predicted_rules = predictTask5Rules(table, groups, order);
+    vector<SymbolId> lexicographic = lexicographicOrder(table, groups);
+    double lexicographic_rules = predictTask5Rules(table, groups, lexicographic);
+    if (lexicographic_rules <= predicted_rules)
+    {
+        predicted_rules = lexicographic_rules;
+        return lexicographic;
+    }
+    return order;
+}
+
+vector<int> lastSubstitution(const ProductionTable &table, const Task5Groups &groups, const vector<SymbolId> &order)
+// Largest position over the non terminals that reach A, one pass over the
+// components from the ones nothing reaches down
+{
+    SymbolId n = groups.size();
+    vector<int> position(n);
+    for (size_t i = 0; i < order.size(); i++)
+        position[order[i]] = i;
+    vector<vector<SymbolId>> edges = leftCornerEdges(table, groups);
+    vector<vector<SymbolId>> components = leftCornerComponents(edges);
+
+    vector<int> component_of(n);
+    for (size_t k = 0; k < components.size(); k++)
+    {
+        for (SymbolId a : components[k])
+            component_of[a] = k;
+    }
+    vector<int> reached_from(components.size(), -1);
+    vector<int> last(n);
+    for (size_t k = components.size(); k-- > 0;)
+    {
+        int latest = reached_from[k];
+        for (SymbolId a : components[k])
+            latest = max(latest, position[a]);
+        for (SymbolId a : components[k])
+        {
+            last[a] = latest;
+            for (SymbolId b : edges[a])
+                reached_from[component_of[b]] = max(reached_from[component_of[b]], latest);
+        }
+    }
+    return last;
+}
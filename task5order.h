@@ -0,0 +1,49 @@
+/*
+ * Order in which Task5 eliminates left recursion.
+ *
+ * Task5 goes through the non terminals A1 .. An in some order, replaces
+ * every rule Ai -> Aj x with j < i by one rule per rule of Aj, and then
+ * removes the immediate left recursion of Ai. A rule Ai -> Aj x with j > i
+ * is left alone, so the size of the output depends on the order: along a
+ * chain of left corners the alternative counts multiply.
+ *
+ * The dependency order works on the left corner graph (A -> B if a rule
+ * of A starts with B). Its strongly connected components are taken in
+ * topological order, a component before the ones its rules start with, so
+ * only left corners inside a component are substituted. Inside a component
+ * the non terminals whose rules would be copied least (alternatives times
+ * rules of the component starting with them) go first.
+ *
+ * The prediction follows the elimination on counts only: the number of
+ * rules of each non terminal by first symbol. It is the number of rules
+ * Task5 prints, except when a new non terminal (A1 for A) has the name of
+ * one the grammar already has and is printed twice.
+ *
+ * Every rule of Ai starts with a symbol reachable from Ai in the left corner
+ * graph of the input, before and after each step. So the rules of Aj are
+ * substituted only into non terminals with a chain of left corners to Aj,
+ * and once the last of them is done the rules of Aj are not read again.
+ */
+#ifndef __TASK5ORDER__H__
+#define __TASK5ORDER__H__
+
+#include <vector>
+
+#include "productions.h"
+
+// groups[A] holds the productions of non terminal A; the non terminals
+// are the symbols 0 .. groups.size() - 1 of table
+typedef std::vector<std::vector<ProductionId>> Task5Groups;
+
+// The order Task5 uses by default, by name
+std::vector<SymbolId> lexicographicOrder(const ProductionTable &table, const Task5Groups &groups);
+// Dependency order as above, or the lexicographic one if that is predicted
+// to print fewer rules; predicted_rules is the prediction for the result
+std::vector<SymbolId> dependencyOrder(const ProductionTable &table, const Task5Groups &groups, double &predicted_rules);
+// Number of rules Task5 prints when it eliminates in this order
+double predictTask5Rules(const ProductionTable &table, const Task5Groups &groups, const std::vector<SymbolId> &order);
+// For every non terminal, the last position in order that may still read
+// its rules (at least its own position)
+std::vector<int> lastSubstitution(const ProductionTable &table, const Task5Groups &groups, const std::vector<SymbolId> &order);
+
+#endif //__TASK5ORDER__H__
@@ -0,0 +1,101 @@
+/*
+ * Minimal perfect hash of the terminal names of a grammar.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "terminalhash.h"
+
+using namespace std;
+
+TerminalHash::TerminalHash(const vector<string> &keys) : seed(0)
+{
+    if (keys.empty())
+        return;
+    // Two names with the same 64 bit hash in one bucket, or a bucket that
+    // finds no free slots, take a new seed
+    while (!Build(keys))
+        seed++;
+}
+
+bool TerminalHash::Build(const vector<string> &keys)
+{
+    size_t n = keys.size();
+    displacements.assign(n / 4 + 1, 0);
+    slot_ids.assign(n, -1);
+
+    // The keys of bucket b are bucket_keys[bucket_start[b] ..
+    // bucket_start[b + 1]]
+    size_t bucket_count = displacements.size();
+    vector<uint64_t> hashes(n);
+    vector<uint32_t> bucket_start(bucket_count + 1, 0);
+    for (size_t i = 0; i < n; i++)
+    {
+        hashes[i] = Hash(keys[i], seed);
+        bucket_start[Bucket(hashes[i]) + 1]++;
+    }
+    for (size_t b = 0; b < bucket_count; b++)
+        bucket_start[b + 1] += bucket_start[b];
+    vector<uint32_t> bucket_keys(n);
+    vector<uint32_t> filled(bucket_start.begin(), bucket_start.end() - 1);
+    for (size_t i = 0; i < n; i++)
+        bucket_keys[filled[Bucket(hashes[i])]++] = i;
+
+    vector<uint32_t> order(bucket_count);
+    for (size_t b = 0; b < bucket_count; b++)
+        order[b] = b;
+    auto size = [&bucket_start](uint32_t b)
+    { return bucket_start[b + 1] - bucket_start[b]; };
+    stable_sort(order.begin(), order.end(), [&size](uint32_t a, uint32_t b)
+                { return size(a) > size(b); });
+
+    vector<uint32_t> slots;
+    for (uint32_t b : order)
+    {
+        if (size(b) == 0)
+            break;
+        const uint32_t *first = bucket_keys.data() + bucket_start[b];
+        const uint32_t *last = bucket_keys.data() + bucket_start[b + 1];
+        // A bucket of one needs n / free tries on average
+        uint32_t displacement = 0;
+        uint32_t tries = 16 * n + 64;
+        for (; displacement < tries; displacement++)
+        {
+            slots.clear();
+            bool fits = true;
+            for (const uint32_t *key = first; key != last; key++)
+            {
+                uint32_t slot = Slot(hashes[*key], displacement);
+                if (slot_ids[slot] >= 0 || find(slots.begin(), slots.end(), slot) != slots.end())
+                {
+                    fits = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (fits)
+                break;
+        }
+        if (displacement == tries)
+            return false;
+        displacements[b] = displacement;
+        for (size_t k = 0; k < slots.size(); k++)
+            slot_ids[slots[k]] = first[k];
+    }
+
+    size_t length = 0;
+    for (const string &key : keys)
+        length += key.size();
+    names.clear();
+    names.reserve(length);
+    name_start.reserve(n + 1);
+    name_start.assign(1, 0);
+    for (size_t slot = 0; slot < n; slot++)
+    {
+        names += keys[slot_ids[slot]];
+        name_start.push_back(names.size());
+    }
+    return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Minimal perfect hash of the terminal names of a grammar.
+ *
+ * Built once from the terminals (hash and displace, as in CHD): every name
+ * is hashed to 64 bits, the names are spread over buckets of about four by
+ * the high half, and the buckets, largest first, each get the smallest
+ * displacement that sends all their names to slots nobody took yet. Every
+ * slot ends up with exactly one name. Looking a word up hashes it once,
+ * reads one displacement and one slot, and compares the word with the name
+ * stored there, so words that are not terminals are rejected too. Nothing
+ * is allocated after the build.
+ */
+#ifndef __TERMINALHASH__H__
+#define __TERMINALHASH__H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class TerminalHash
+{
+  public:
+    TerminalHash() : seed(0) {}
+    // names[i] gets id i; the names must be distinct
+    explicit TerminalHash(const std::vector<std::string> &names);
+
+    // Id of the name equal to word, or -1
+    int Find(std::string_view word) const
+    {
+        if (slot_ids.empty())
+            return -1;
+        uint64_t hash = Hash(word, seed);
+        uint32_t slot = Slot(hash, displacements[Bucket(hash)]);
+        const char *name = names.data() + name_start[slot];
+        std::size_t length = name_start[slot + 1] - name_start[slot];
+        if (length != word.size() || word.compare(0, length, name, length) != 0)
+            return -1;
+        return slot_ids[slot];
+    }
+
+    std::size_t Size() const { return slot_ids.size(); }
+
+  private:
+    // The multiply and fold of wyhash: names of up to 16 bytes are read as
+    // two overlapping words, longer ones 16 bytes at a time
+    static uint64_t Mix(uint64_t a, uint64_t b)
+    {
+        __uint128_t product = (__uint128_t)a * b;
+        return uint64_t(product) ^ uint64_t(product >> 64);
+    }
+    static uint64_t Load(const char *data, std::size_t bytes)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, data, bytes);
+        return word;
+    }
+    static uint64_t Hash(std::string_view word, uint64_t seed)
+    {
+        const uint64_t K0 = 0xa0761d6478bd642full, K1 = 0xe7037ed1a0b428dbull;
+        const char *data = word.data();
+        std::size_t length = word.size();
+        seed ^= K0;
+        uint64_t a = 0, b = 0;
+        if (length <= 16)
+        {
+            if (length >= 8)
+            {
+                a = Load(data, 8);
+                b = Load(data + length - 8, 8);
+            }
+            else if (length >= 4)
+            {
+                a = Load(data, 4);
+                b = Load(data + length - 4, 4);
+            }
+            else if (length > 0)
+                a = uint64_t((unsigned char)data[0]) << 16 | uint64_t((unsigned char)data[length / 2]) << 8 | (unsigned char)data[length - 1];
+        }
+        else
+        {
+            const char *end = data + length;
+            for (; end - data > 16; data += 16)
+                seed = Mix(Load(data, 8) ^ K1, Load(data + 8, 8) ^ seed);
+            a = Load(end - 16, 8);
+            b = Load(end - 8, 8);
+        }
+        return Mix(K1 ^ length, Mix(a ^ K1, b ^ seed));
+    }
+    // x * size / 2^32 maps 32 bits onto 0 .. size - 1 without a division
+    uint32_t Bucket(uint64_t hash) const { return (hash >> 32) * displacements.size() >> 32; }
+    uint32_t Slot(uint64_t hash, uint32_t displacement) const
+    {
+        uint64_t mixed = (hash + displacement * 0x9e3779b97f4a7c15ull) * 0xbf58476d1ce4e5b9ull;
+        return (mixed >> 32) * slot_ids.size() >> 32;
+    }
+
+    bool Build(const std::vector<std::string> &keys);
+
+    uint64_t seed;
+    std::vector<uint32_t> displacements; // per bucket
+    std::vector<int> slot_ids;           // per slot
+    std::vector<uint32_t> name_start;    // per slot, into names, and the end
+    std::string names;                   // the name of each slot, in slot order
+};
+
+#endif //__TERMINALHASH__H__